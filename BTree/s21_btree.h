@@ -0,0 +1,1073 @@
+#ifndef S21_BTREE_H
+#define S21_BTREE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "../RBtree/s21_node_pool.h"
+
+namespace s21 {
+
+// B+-дерево: элементы хранятся только в листьях, внутренние узлы содержат
+// копии ключей-разделителей. Узлы занимают несколько кэш-линий, поэтому
+// спуск делает один промах кэша на уровень при высоте в 3-4 раза меньше,
+// чем у RBTree.
+//
+// Листья связаны в двусвязный список и выровнены по своему размеру (степень
+// двойки), так что лист находится по адресу элемента маской. Благодаря этому
+// позиция в дереве — один указатель Node*, и BTree подставляется в set и
+// multiset вместо RBTree без изменения их итераторов. В отличие от RBTree,
+// вставка и удаление сдвигают элементы внутри узлов: итераторы на
+// изменённые узлы становятся недействительными, как у других B-деревьев.
+//
+// Разделитель keys[i] внутреннего узла не меньше всех ключей ребенка i и
+// не больше всех ключей ребенка i + 1.
+template <typename Key, bool AllowDuplicates = false,
+          typename Compare = std::less<Key>>
+class BTree {
+ public:
+  // Ячейка листа с элементом; указатель на неё служит позицией в дереве
+  struct Node {
+    Key data;
+  };
+
+ private:
+  struct Leaf;
+
+  struct LeafLinks {
+    Leaf* prev = nullptr;
+    Leaf* next = nullptr;
+    size_t count = 0;
+  };
+
+  static constexpr size_t kNodeBytes = 256;
+  static constexpr size_t kMaxHeight = 64;
+
+  static constexpr size_t roundUp(size_t value, size_t align) {
+    return (value + align - 1) / align * align;
+  }
+
+  static constexpr size_t ceilPow2(size_t value) {
+    size_t result = 1;
+    while (result < value) {
+      result <<= 1;
+    }
+    return result;
+  }
+
+  static constexpr size_t kLeafOffset =
+      roundUp(sizeof(LeafLinks), alignof(Node));
+  static constexpr size_t kLeafSlots =
+      std::max<size_t>(4, (kNodeBytes - kLeafOffset) / sizeof(Node));
+  static constexpr size_t kLeafAlign =
+      ceilPow2(kLeafOffset + kLeafSlots * sizeof(Node));
+  static constexpr size_t kLeafMin = kLeafSlots / 2;
+
+  // Число детей внутреннего узла; ключей на один меньше
+  static constexpr size_t kInnerSlots = std::max<size_t>(
+      4, (kNodeBytes + sizeof(Node)) / (sizeof(Node) + sizeof(void*)));
+  static constexpr size_t kInnerMinKeys = (kInnerSlots + 1) / 2 - 1;
+
+  struct alignas(kLeafAlign) Leaf : LeafLinks {
+    alignas(Node) unsigned char storage[kLeafSlots * sizeof(Node)];
+
+    Node* slots() { return reinterpret_cast<Node*>(storage); }
+    const Node* slots() const {
+      return reinterpret_cast<const Node*>(storage);
+    }
+  };
+
+  static_assert(sizeof(Leaf) == kLeafAlign, "leaf must fill its alignment");
+
+  struct Inner {
+    size_t count = 0;  // число ключей
+    void* children[kInnerSlots];
+    alignas(Node) unsigned char storage[(kInnerSlots - 1) * sizeof(Node)];
+
+    Node* keys() { return reinterpret_cast<Node*>(storage); }
+  };
+
+  // Внутренний узел на пути спуска и номер ребенка, в который ушёл спуск
+  struct PathStep {
+    Inner* node;
+    size_t index;
+  };
+
+ public:
+  // Листья и внутренние узлы имеют разный размер и берутся из своих пулов
+  class node_pool {
+   public:
+    size_t in_use() const { return leaves_.in_use() + inners_.in_use(); }
+
+    size_t capacity_bytes() const {
+      return leaves_.capacity() * sizeof(Leaf) +
+             inners_.capacity() * sizeof(Inner);
+    }
+
+    void release() noexcept {
+      leaves_.release();
+      inners_.release();
+    }
+
+   private:
+    friend class BTree;
+
+    NodePool<Leaf> leaves_;
+    NodePool<Inner> inners_;
+  };
+
+  // Отдельного узла на элемент у B+-дерева нет, поэтому извлечённый
+  // элемент хранится в handle сам, перемещённым из листа
+  class node_handle {
+   public:
+    node_handle() = default;
+
+    node_handle(node_handle&& other) noexcept(
+        std::is_nothrow_move_constructible_v<Key>)
+        : key_(std::move(other.key_)) {
+      other.key_.reset();
+    }
+
+    node_handle& operator=(node_handle&& other) noexcept(
+        std::is_nothrow_move_assignable_v<Key>) {
+      if (this != &other) {
+        key_ = std::move(other.key_);
+        other.key_.reset();
+      }
+      return *this;
+    }
+
+    bool empty() const { return !key_; }
+    explicit operator bool() const { return key_.has_value(); }
+
+    Key& value() const { return *key_; }
+
+   private:
+    friend class BTree;
+
+    explicit node_handle(Key&& key) : key_(std::move(key)) {}
+
+    mutable std::optional<Key> key_;
+  };
+
+  BTree() = default;
+
+  explicit BTree(const Compare& comp) : comp_(comp) {}
+
+  explicit BTree(std::shared_ptr<node_pool> pool,
+                 const Compare& comp = Compare())
+      : pool_(std::move(pool)), comp_(comp) {}
+
+  BTree(const BTree& other) : comp_(other.comp_) { cloneFrom(other); }
+
+  BTree(BTree&& other)
+      : root_(other.root_),
+        head_(other.head_),
+        tail_(other.tail_),
+        height_(other.height_),
+        size_(other.size_),
+        pool_(std::move(other.pool_)),
+        comp_(std::move(other.comp_)) {
+    other.reset();
+  }
+
+  BTree& operator=(const BTree& other) {
+    if (this != &other) {
+      clear();
+      comp_ = other.comp_;
+      cloneFrom(other);
+    }
+    return *this;
+  }
+
+  BTree& operator=(BTree&& other) {
+    if (this != &other) {
+      clear();
+      root_ = other.root_;
+      head_ = other.head_;
+      tail_ = other.tail_;
+      height_ = other.height_;
+      size_ = other.size_;
+      pool_ = std::move(other.pool_);
+      comp_ = std::move(other.comp_);
+      other.reset();
+    }
+    return *this;
+  }
+
+  ~BTree() { clear(); }
+
+  bool empty() const { return size_ == 0; }
+
+  size_t size() const { return size_; }
+
+  size_t max_size() const {
+    return std::numeric_limits<size_t>::max() / sizeof(Node);
+  }
+
+  Compare key_comp() const { return comp_; }
+
+  const std::shared_ptr<node_pool>& pool() {
+    if (!pool_) {
+      pool_ = std::make_shared<node_pool>();
+    }
+    return pool_;
+  }
+
+  // Первый элемент в порядке обхода или nullptr для пустого дерева
+  Node* first() const { return head_ ? head_->slots() : nullptr; }
+
+  // Последний элемент или nullptr для пустого дерева
+  Node* last() const {
+    return tail_ ? tail_->slots() + tail_->count - 1 : nullptr;
+  }
+
+  static Node* successor(const Node* node) {
+    Leaf* leaf = leafOf(node);
+    if (node + 1 != leaf->slots() + leaf->count) {
+      return const_cast<Node*>(node + 1);
+    }
+    return leaf->next ? leaf->next->slots() : nullptr;
+  }
+
+  static Node* predecessor(const Node* node) {
+    Leaf* leaf = leafOf(node);
+    if (node != leaf->slots()) {
+      return const_cast<Node*>(node - 1);
+    }
+    Leaf* prev = leaf->prev;
+    return prev ? prev->slots() + prev->count - 1 : nullptr;
+  }
+
+  // Вставка за один спуск. Возвращает вставленный элемент либо, если
+  // дубликаты запрещены, уже имеющийся равный.
+  std::pair<Node*, bool> insert(const Key& value) { return insertValue(value); }
+
+  std::pair<Node*, bool> insert(Key&& value) {
+    return insertValue(std::move(value));
+  }
+
+  // Элементы листа хранятся по значению и сдвигаются при вставке, так что
+  // ключ сначала строится отдельно, а затем перемещается на своё место
+  template <typename... Args>
+  std::pair<Node*, bool> emplace(Args&&... args) {
+    return insertValue(Key(std::forward<Args>(args)...));
+  }
+
+  // Подсказка не используется: путь от корня всё равно нужен для деления
+  // листа, а спуск по B+-дереву короткий. Вставка в конец и так не делит
+  // лист пополам.
+  template <typename V>
+  std::pair<Node*, bool> insertHint(const Node* hint, V&& value) {
+    (void)hint;
+    return insert(std::forward<V>(value));
+  }
+
+  template <typename... Args>
+  std::pair<Node*, bool> emplaceHint(const Node* hint, Args&&... args) {
+    (void)hint;
+    return emplace(std::forward<Args>(args)...);
+  }
+
+  // Отсортированный диапазон в пустое дерево собирается за O(n) с плотно
+  // заполненными листьями, в остальных случаях элементы вставляются по
+  // одному
+  template <typename InputIt>
+  void insertRange(InputIt first, InputIt last) {
+    using category = typename std::iterator_traits<InputIt>::iterator_category;
+    if constexpr (std::is_base_of_v<std::forward_iterator_tag, category>) {
+      if (empty() && isSortedRange(first, last)) {
+        size_t count = static_cast<size_t>(std::distance(first, last));
+        buildFromSorted(count, [&first]() -> decltype(auto) {
+          decltype(auto) value = *first;
+          ++first;
+          return value;
+        });
+        return;
+      }
+    }
+    for (; first != last; ++first) {
+      insert(*first);
+    }
+  }
+
+  // Удаляет один элемент, равный value (первый из равных)
+  void erase(const Key& value) {
+    if (!root_) {
+      return;
+    }
+    PathStep path[kMaxHeight];
+    Leaf* leaf = descend<false>(value, path);
+    size_t pos = lowerIndex(leaf->slots(), leaf->count, value);
+    if (pos == leaf->count) {
+      if (!leaf->next) {
+        return;
+      }
+      leaf = nextLeaf(path);
+      pos = 0;
+    }
+    if (comp_(value, leaf->slots()[pos].data)) {
+      return;
+    }
+    removeAt(leaf, pos, path);
+  }
+
+  // Удаляет именно этот элемент, а не первый из равных ему, и возвращает
+  // следующий. Путь к листу ищется спуском по ключу, поэтому O(log n).
+  // Удаление сдвигает соседние элементы, так что прежние указатели на них
+  // недействительны, а возвращённый — верный.
+  Node* eraseAt(Node* node) {
+    PathStep path[kMaxHeight];
+    Leaf* leaf = pathTo(node, path);
+    return removeAt(leaf, static_cast<size_t>(node - leaf->slots()), path);
+  }
+
+  // Удаляет элементы [first, last). Указатель last сдвигается вместе с
+  // элементами, поэтому сначала считается длина диапазона; возвращается
+  // элемент, стоявший на месте last.
+  Node* eraseRange(Node* first, Node* last) {
+    if (first == this->first() && !last) {
+      clear();
+      return nullptr;
+    }
+    size_t count = 0;
+    for (const Node* node = first; node != last; node = successor(node)) {
+      count++;
+    }
+    for (; count > 0; --count) {
+      first = eraseAt(first);
+    }
+    return first;
+  }
+
+  // Перемещает элемент в handle и удаляет его из дерева
+  node_handle extract(Node* node) {
+    PathStep path[kMaxHeight];
+    Leaf* leaf = pathTo(node, path);
+    node_handle handle(std::move(node->data));
+    removeAt(leaf, static_cast<size_t>(node - leaf->slots()), path);
+    return handle;
+  }
+
+  node_handle extract(const Key& value) {
+    Node* node = find(value);
+    return node ? extract(node) : node_handle();
+  }
+
+  // Ключ забирается из handle, только если вставка состоялась
+  std::pair<Node*, bool> insert(node_handle&& handle) {
+    if (handle.empty()) {
+      return {nullptr, false};
+    }
+    auto result = insertValue(std::move(*handle.key_));
+    if (result.second) {
+      handle.key_.reset();
+    }
+    return result;
+  }
+
+  // Переносит из other элементы, которых в дереве нет (в мультисет — все).
+  // Элементы листов перемещаются, а не копируются. Путь к элементу в other
+  // ищется до перемещения, пока ключ ещё цел.
+  void merge(BTree& other) {
+    if (this == &other) {
+      return;
+    }
+    for (Node* node = other.first(); node;) {
+      PathStep path[kMaxHeight];
+      Leaf* leaf = other.pathTo(node, path);
+      if (insertValue(std::move(node->data)).second) {
+        size_t pos = static_cast<size_t>(node - leaf->slots());
+        node = other.removeAt(leaf, pos, path);
+      } else {
+        node = successor(node);
+      }
+    }
+  }
+
+  // Удаление минимума и максимума: спуск по крайним детям без сравнений.
+  // Пустое дерево не меняется.
+  void popFirst() {
+    if (size_) {
+      PathStep path[kMaxHeight];
+      removeAt(descendEdge<false>(path), 0, path);
+    }
+  }
+
+  void popLast() {
+    if (size_) {
+      PathStep path[kMaxHeight];
+      Leaf* leaf = descendEdge<true>(path);
+      removeAt(leaf, leaf->count - 1, path);
+    }
+  }
+
+  void clear() {
+    if (root_) {
+      if (std::is_trivially_destructible_v<Key> && pool_.use_count() == 1) {
+        // Узлы не требуют деструкторов, а пул только наш: отдаём слэбы
+        // целиком вместо обхода дерева
+        pool_->release();
+      } else {
+        destroySubtree(root_, 0);
+      }
+    }
+    reset();
+  }
+
+  Node* find(const Key& value) const { return findNode(value); }
+
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  Node* find(const K& key) const {
+    return findNode(key);
+  }
+
+  bool contains(const Key& value) const { return findNode(value) != nullptr; }
+
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  bool contains(const K& key) const {
+    return findNode(key) != nullptr;
+  }
+
+  size_t count(const Key& value) const { return countKeys(value); }
+
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  size_t count(const K& key) const {
+    return countKeys(key);
+  }
+
+  // Первый элемент не меньше заданного
+  Node* lower_bound(const Key& value) const { return lowerBoundNode(value); }
+
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  Node* lower_bound(const K& key) const {
+    return lowerBoundNode(key);
+  }
+
+  // Первый элемент строго больше заданного
+  Node* upper_bound(const Key& value) const { return upperBoundNode(value); }
+
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  Node* upper_bound(const K& key) const {
+    return upperBoundNode(key);
+  }
+
+  std::pair<Node*, Node*> equal_range(const Key& value) const {
+    return equalRangeNodes(value);
+  }
+
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  std::pair<Node*, Node*> equal_range(const K& key) const {
+    return equalRangeNodes(key);
+  }
+
+ private:
+  template <typename V>
+  std::pair<Node*, bool> insertValue(V&& value) {
+    if (!root_) {
+      head_ = tail_ = createLeaf();
+      root_ = head_;
+    }
+    PathStep path[kMaxHeight];
+    Leaf* leaf = descend<true>(value, path);
+    size_t pos = upperIndex(leaf->slots(), leaf->count, value);
+    if constexpr (!AllowDuplicates) {
+      // Равный ключ может быть только непосредственно перед позицией
+      // вставки, в том числе последним в предыдущем листе
+      Node* prev = pos > 0       ? leaf->slots() + pos - 1
+                   : leaf->prev ? leaf->prev->slots() + leaf->prev->count - 1
+                                : nullptr;
+      if (prev && !comp_(prev->data, value)) {
+        return {prev, false};
+      }
+    }
+    if (leaf->count == kLeafSlots) {
+      if (pos == kLeafSlots && !leaf->next) {
+        // Вставка в конец дерева: новый лист вместо деления пополам, чтобы
+        // при возрастающем потоке листья оставались заполненными
+        Leaf* right = appendLeaf(leaf);
+        new (right->slots()) Node{std::forward<V>(value)};
+        right->count = 1;
+        size_++;
+        insertIntoParent(height_, leaf, right->slots()->data, right, path);
+        return {right->slots(), true};
+      }
+      Leaf* right = splitLeaf(leaf, path);
+      if (pos > leaf->count) {
+        pos -= leaf->count;
+        leaf = right;
+      }
+    }
+    insertSlot(leaf->slots(), leaf->count, pos, std::forward<V>(value));
+    leaf->count++;
+    size_++;
+    return {leaf->slots() + pos, true};
+  }
+
+  static Leaf* leafOf(const Node* node) {
+    return reinterpret_cast<Leaf*>(reinterpret_cast<uintptr_t>(node) &
+                                   ~static_cast<uintptr_t>(kLeafAlign - 1));
+  }
+
+  void reset() {
+    root_ = nullptr;
+    head_ = nullptr;
+    tail_ = nullptr;
+    height_ = 0;
+    size_ = 0;
+  }
+
+  Leaf* createLeaf() {
+    return new (pool()->leaves_.allocate()) Leaf;
+  }
+
+  Inner* createInner() {
+    return new (pool()->inners_.allocate()) Inner;
+  }
+
+  // Элементы узла к этому моменту уже разрушены или перенесены
+  void destroyLeaf(Leaf* leaf) { pool_->leaves_.deallocate(leaf); }
+
+  void destroyInner(Inner* inner) { pool_->inners_.deallocate(inner); }
+
+  // Узлы дерева освобождаются рекурсивно: глубина равна высоте дерева,
+  // которая даже для миллиардов элементов не превышает десятка уровней
+  void destroySubtree(void* node, size_t depth) {
+    if (depth == height_) {
+      Leaf* leaf = static_cast<Leaf*>(node);
+      std::destroy(leaf->slots(), leaf->slots() + leaf->count);
+      destroyLeaf(leaf);
+      return;
+    }
+    Inner* inner = static_cast<Inner*>(node);
+    for (size_t i = 0; i <= inner->count; ++i) {
+      destroySubtree(inner->children[i], depth + 1);
+    }
+    std::destroy(inner->keys(), inner->keys() + inner->count);
+    destroyInner(inner);
+  }
+
+  // Вставляет value в позицию pos массива из count сконструированных ячеек
+  template <typename V>
+  static void insertSlot(Node* slots, size_t count, size_t pos, V&& value) {
+    if (pos == count) {
+      new (slots + count) Node{std::forward<V>(value)};
+      return;
+    }
+    new (slots + count) Node{std::move(slots[count - 1].data)};
+    std::move_backward(slots + pos, slots + count - 1, slots + count);
+    slots[pos].data = std::forward<V>(value);
+  }
+
+  static void eraseSlot(Node* slots, size_t count, size_t pos) {
+    std::move(slots + pos + 1, slots + count, slots + pos);
+    slots[count - 1].~Node();
+  }
+
+  // Двоичный поиск внутри узла без ветвлений: на каждом шаге граница
+  // выбирается через cmov, и непредсказуемые сравнения не сбрасывают
+  // конвейер. Возвращает число ячеек меньше key.
+  template <typename K>
+  size_t lowerIndex(const Node* slots, size_t count, const K& key) const {
+    const Node* base = slots;
+    size_t n = count;
+    while (n > 1) {
+      size_t half = n / 2;
+      base = comp_(base[half].data, key) ? base + half : base;
+      n -= half;
+    }
+    return (base - slots) + (n == 1 && comp_(base->data, key));
+  }
+
+  // Число ячеек, не больших key
+  template <typename K>
+  size_t upperIndex(const Node* slots, size_t count, const K& key) const {
+    const Node* base = slots;
+    size_t n = count;
+    while (n > 1) {
+      size_t half = n / 2;
+      base = comp_(key, base[half].data) ? base : base + half;
+      n -= half;
+    }
+    return (base - slots) + (n == 1 && !comp_(key, base->data));
+  }
+
+  // Спуск к листу. Upper выбирает первого ребенка с разделителем больше
+  // key (позиция вставки), иначе — первого с разделителем не меньше key.
+  // Если path задан, в него записывается пройденный путь.
+  template <bool Upper, typename K>
+  Leaf* descend(const K& key, PathStep* path) const {
+    void* node = root_;
+    for (size_t depth = 0; depth < height_; ++depth) {
+      Inner* inner = static_cast<Inner*>(node);
+      size_t index = Upper ? upperIndex(inner->keys(), inner->count, key)
+                           : lowerIndex(inner->keys(), inner->count, key);
+      if (path) {
+        path[depth] = {inner, index};
+      }
+      node = inner->children[index];
+      prefetch(node, depth + 1 == height_ ? sizeof(Leaf) : sizeof(Inner));
+    }
+    return static_cast<Leaf*>(node);
+  }
+
+  // Запрашивает все кэш-линии узла сразу, чтобы промахи двоичного поиска
+  // внутри узла шли параллельно, а не друг за другом
+  static void prefetch(const void* node, size_t bytes) {
+#if defined(__GNUC__)
+    const char* begin = static_cast<const char*>(node);
+    for (size_t offset = 0; offset < bytes; offset += 64) {
+      __builtin_prefetch(begin + offset);
+    }
+#else
+    (void)node;
+    (void)bytes;
+#endif
+  }
+
+  // Спуск к самому левому или, если Right, самому правому листу
+  template <bool Right>
+  Leaf* descendEdge(PathStep* path) const {
+    void* node = root_;
+    for (size_t depth = 0; depth < height_; ++depth) {
+      Inner* inner = static_cast<Inner*>(node);
+      size_t index = Right ? inner->count : 0;
+      path[depth] = {inner, index};
+      node = inner->children[index];
+    }
+    return static_cast<Leaf*>(node);
+  }
+
+  // Спуск к листу с элементом node; среди равных ключей нужный лист
+  // может оказаться правее того, куда приводит поиск
+  Leaf* pathTo(const Node* node, PathStep* path) const {
+    Leaf* target = leafOf(node);
+    Leaf* leaf = descend<false>(node->data, path);
+    while (leaf != target) {
+      leaf = nextLeaf(path);
+    }
+    return leaf;
+  }
+
+  // Удаляет элемент pos листа, до которого ведёт path, и возвращает
+  // следующий за ним
+  Node* removeAt(Leaf* leaf, size_t pos, PathStep* path) {
+    eraseSlot(leaf->slots(), leaf->count, pos);
+    leaf->count--;
+    size_--;
+    return rebalanceLeaf(leaf, pos, path);
+  }
+
+  // Переводит путь на следующий лист; он должен существовать
+  Leaf* nextLeaf(PathStep* path) const {
+    size_t depth = height_;
+    while (path[depth - 1].index == path[depth - 1].node->count) {
+      depth--;
+    }
+    path[depth - 1].index++;
+    void* node = path[depth - 1].node->children[path[depth - 1].index];
+    for (; depth < height_; ++depth) {
+      path[depth] = {static_cast<Inner*>(node), 0};
+      node = static_cast<Inner*>(node)->children[0];
+    }
+    return static_cast<Leaf*>(node);
+  }
+
+  template <typename K>
+  Node* lowerBoundNode(const K& key) const {
+    if (!root_) {
+      return nullptr;
+    }
+    Leaf* leaf = descend<false>(key, nullptr);
+    size_t pos = lowerIndex(leaf->slots(), leaf->count, key);
+    if (pos < leaf->count) {
+      return leaf->slots() + pos;
+    }
+    return leaf->next ? leaf->next->slots() : nullptr;
+  }
+
+  template <typename K>
+  Node* upperBoundNode(const K& key) const {
+    if (!root_) {
+      return nullptr;
+    }
+    Leaf* leaf = descend<true>(key, nullptr);
+    size_t pos = upperIndex(leaf->slots(), leaf->count, key);
+    if (pos < leaf->count) {
+      return leaf->slots() + pos;
+    }
+    return leaf->next ? leaf->next->slots() : nullptr;
+  }
+
+  template <typename K>
+  Node* findNode(const K& key) const {
+    Node* node = lowerBoundNode(key);
+    return (node && !comp_(key, node->data)) ? node : nullptr;
+  }
+
+  template <typename K>
+  std::pair<Node*, Node*> equalRangeNodes(const K& key) const {
+    Node* lower = lowerBoundNode(key);
+    if constexpr (!AllowDuplicates) {
+      if (lower && !comp_(key, lower->data)) {
+        return {lower, successor(lower)};
+      }
+      return {lower, lower};
+    } else {
+      return {lower, upperBoundNode(key)};
+    }
+  }
+
+  template <typename K>
+  size_t countKeys(const K& key) const {
+    if constexpr (!AllowDuplicates) {
+      return findNode(key) ? 1 : 0;
+    } else {
+      auto [first, last] = equalRangeNodes(key);
+      size_t cnt = 0;
+      for (const Node* node = first; node != last; node = successor(node)) {
+        cnt++;
+      }
+      return cnt;
+    }
+  }
+
+  template <typename ForwardIt>
+  bool isSortedRange(ForwardIt first, ForwardIt last) const {
+    if constexpr (AllowDuplicates) {
+      return std::is_sorted(first, last, comp_);
+    } else {
+      return std::adjacent_find(first, last, [this](const auto& lhs,
+                                                    const auto& rhs) {
+               return !comp_(lhs, rhs);
+             }) == last;
+    }
+  }
+
+  void cloneFrom(const BTree& other) {
+    const Node* node = other.first();
+    buildFromSorted(other.size_, [&node, &other]() -> const Key& {
+      const Key& value = node->data;
+      node = other.successor(node);
+      return value;
+    });
+  }
+
+  // Строит дерево из count упорядоченных элементов, которые по одному
+  // выдаёт next(). Элементы поровну распределяются по минимально
+  // возможному числу листьев, затем так же собираются уровни выше.
+  template <typename Next>
+  void buildFromSorted(size_t count, Next next) {
+    if (count == 0) {
+      return;
+    }
+    std::vector<void*> level;
+    std::vector<const Node*> mins;  // минимальный элемент под каждым узлом
+    std::vector<Inner*> inners;
+    try {
+      size_t leaves = (count + kLeafSlots - 1) / kLeafSlots;
+      level.reserve(leaves);
+      mins.reserve(leaves);
+      Leaf* prev = nullptr;
+      for (size_t i = 0; i < leaves; ++i) {
+        Leaf* leaf = createLeaf();
+        leaf->prev = prev;
+        (prev ? prev->next : head_) = leaf;
+        prev = tail_ = leaf;
+        size_t take = count / leaves + (i < count % leaves ? 1 : 0);
+        for (size_t j = 0; j < take; ++j) {
+          new (leaf->slots() + j) Node{next()};
+          leaf->count++;
+        }
+        level.push_back(leaf);
+        mins.push_back(leaf->slots());
+      }
+      while (level.size() > 1) {
+        size_t parents = (level.size() + kInnerSlots - 1) / kInnerSlots;
+        std::vector<void*> upper;
+        std::vector<const Node*> upper_mins;
+        upper.reserve(parents);
+        upper_mins.reserve(parents);
+        size_t child = 0;
+        for (size_t i = 0; i < parents; ++i) {
+          size_t take = level.size() / parents +
+                        (i < level.size() % parents ? 1 : 0);
+          Inner* inner = createInner();
+          inners.push_back(inner);
+          inner->children[0] = level[child];
+          for (size_t j = 1; j < take; ++j) {
+            new (inner->keys() + j - 1) Node{mins[child + j]->data};
+            inner->children[j] = level[child + j];
+            inner->count++;
+          }
+          upper.push_back(inner);
+          upper_mins.push_back(mins[child]);
+          child += take;
+        }
+        level.swap(upper);
+        mins.swap(upper_mins);
+        height_++;
+      }
+    } catch (...) {
+      for (Inner* inner : inners) {
+        std::destroy(inner->keys(), inner->keys() + inner->count);
+        destroyInner(inner);
+      }
+      for (Leaf* leaf = head_; leaf;) {
+        Leaf* following = leaf->next;
+        std::destroy(leaf->slots(), leaf->slots() + leaf->count);
+        destroyLeaf(leaf);
+        leaf = following;
+      }
+      reset();
+      throw;
+    }
+    root_ = level.front();
+    size_ = count;
+  }
+
+  // Новый пустой лист сразу после leaf
+  Leaf* appendLeaf(Leaf* leaf) {
+    Leaf* right = createLeaf();
+    right->prev = leaf;
+    right->next = leaf->next;
+    (leaf->next ? leaf->next->prev : tail_) = right;
+    leaf->next = right;
+    return right;
+  }
+
+  // Делит полный лист пополам и добавляет разделитель в родителя
+  Leaf* splitLeaf(Leaf* leaf, PathStep* path) {
+    Leaf* right = appendLeaf(leaf);
+    size_t half = (leaf->count + 1) / 2;
+    Node* slots = leaf->slots();
+    std::uninitialized_move(slots + half, slots + leaf->count,
+                            right->slots());
+    std::destroy(slots + half, slots + leaf->count);
+    right->count = leaf->count - half;
+    leaf->count = half;
+    insertIntoParent(height_, leaf, right->slots()->data, right, path);
+    return right;
+  }
+
+  // Вставляет разделитель и правый узел right после узла left, который
+  // лежит на глубине depth. Переполненные предки делятся снизу вверх.
+  void insertIntoParent(size_t depth, void* left, Key separator, void* right,
+                        PathStep* path) {
+    if (depth == 0) {
+      Inner* root = createInner();
+      new (root->keys()) Node{std::move(separator)};
+      root->count = 1;
+      root->children[0] = left;
+      root->children[1] = right;
+      root_ = root;
+      height_++;
+      return;
+    }
+    Inner* parent = path[depth - 1].node;
+    size_t index = path[depth - 1].index;
+    if (parent->count < kInnerSlots - 1) {
+      insertChild(parent, index, std::move(separator), right);
+      return;
+    }
+    Inner* sibling = createInner();
+    Node* keys = parent->keys();
+    size_t mid = parent->count / 2;
+    Key up = std::move(keys[mid].data);
+    std::uninitialized_move(keys + mid + 1, keys + parent->count,
+                            sibling->keys());
+    std::copy(parent->children + mid + 1,
+              parent->children + parent->count + 1, sibling->children);
+    sibling->count = parent->count - mid - 1;
+    std::destroy(keys + mid, keys + parent->count);
+    parent->count = mid;
+    if (index <= mid) {
+      insertChild(parent, index, std::move(separator), right);
+    } else {
+      insertChild(sibling, index - mid - 1, std::move(separator), right);
+    }
+    insertIntoParent(depth - 1, parent, std::move(up), sibling, path);
+  }
+
+  // Ключ встаёт на место index, ребенок — сразу за ребенком index
+  static void insertChild(Inner* inner, size_t index, Key&& key,
+                          void* child) {
+    insertSlot(inner->keys(), inner->count, index, std::move(key));
+    std::move_backward(inner->children + index + 1,
+                       inner->children + inner->count + 1,
+                       inner->children + inner->count + 2);
+    inner->children[index + 1] = child;
+    inner->count++;
+  }
+
+  // Убирает ключ index и ребенка index + 1
+  static void removeChild(Inner* inner, size_t index) {
+    eraseSlot(inner->keys(), inner->count, index);
+    std::move(inner->children + index + 2, inner->children + inner->count + 1,
+              inner->children + index + 1);
+    inner->count--;
+  }
+
+  // Восстанавливает заполненность листа после удаления: занимает элемент у
+  // соседа или сливается с ним. Возвращает элемент, который стоял в
+  // позиции pos листа, с учётом переезда, или следующий за листом.
+  Node* rebalanceLeaf(Leaf* leaf, size_t pos, PathStep* path) {
+    if (height_ == 0) {
+      if (leaf->count == 0) {
+        destroyLeaf(leaf);
+        reset();
+        return nullptr;
+      }
+      return slotOrNext(leaf, pos);
+    }
+    if (leaf->count >= kLeafMin) {
+      return slotOrNext(leaf, pos);
+    }
+    Inner* parent = path[height_ - 1].node;
+    size_t index = path[height_ - 1].index;
+    Leaf* left =
+        index > 0 ? static_cast<Leaf*>(parent->children[index - 1]) : nullptr;
+    Leaf* right = index < parent->count
+                      ? static_cast<Leaf*>(parent->children[index + 1])
+                      : nullptr;
+    if (left && left->count > kLeafMin) {
+      Node* last = left->slots() + left->count - 1;
+      insertSlot(leaf->slots(), leaf->count, 0, std::move(last->data));
+      leaf->count++;
+      last->~Node();
+      left->count--;
+      parent->keys()[index - 1].data = leaf->slots()->data;
+      pos++;
+    } else if (right && right->count > kLeafMin) {
+      new (leaf->slots() + leaf->count) Node{std::move(right->slots()->data)};
+      leaf->count++;
+      eraseSlot(right->slots(), right->count, 0);
+      right->count--;
+      parent->keys()[index].data = right->slots()->data;
+    } else {
+      if (left) {
+        pos += left->count;
+        mergeLeaves(left, leaf);
+        removeChild(parent, index - 1);
+        leaf = left;
+      } else {
+        mergeLeaves(leaf, right);
+        removeChild(parent, index);
+      }
+      rebalanceInner(height_ - 1, path);
+    }
+    return slotOrNext(leaf, pos);
+  }
+
+  static Node* slotOrNext(Leaf* leaf, size_t pos) {
+    if (pos < leaf->count) {
+      return leaf->slots() + pos;
+    }
+    return leaf->next ? leaf->next->slots() : nullptr;
+  }
+
+  void mergeLeaves(Leaf* left, Leaf* right) {
+    std::uninitialized_move(right->slots(), right->slots() + right->count,
+                            left->slots() + left->count);
+    std::destroy(right->slots(), right->slots() + right->count);
+    left->count += right->count;
+    left->next = right->next;
+    (right->next ? right->next->prev : tail_) = left;
+    destroyLeaf(right);
+  }
+
+  // То же для внутреннего узла на глубине depth: ключи перетекают через
+  // разделитель родителя. Корень с единственным ребенком убирается.
+  void rebalanceInner(size_t depth, PathStep* path) {
+    Inner* node = path[depth].node;
+    if (depth == 0) {
+      if (node->count == 0) {
+        root_ = node->children[0];
+        height_--;
+        destroyInner(node);
+      }
+      return;
+    }
+    if (node->count >= kInnerMinKeys) {
+      return;
+    }
+    Inner* parent = path[depth - 1].node;
+    size_t index = path[depth - 1].index;
+    Node* separators = parent->keys();
+    Inner* left = index > 0 ? static_cast<Inner*>(parent->children[index - 1])
+                            : nullptr;
+    Inner* right = index < parent->count
+                       ? static_cast<Inner*>(parent->children[index + 1])
+                       : nullptr;
+    if (left && left->count > kInnerMinKeys) {
+      insertSlot(node->keys(), node->count, 0,
+                 std::move(separators[index - 1].data));
+      std::move_backward(node->children, node->children + node->count + 1,
+                         node->children + node->count + 2);
+      node->children[0] = left->children[left->count];
+      node->count++;
+      Node* last = left->keys() + left->count - 1;
+      separators[index - 1].data = std::move(last->data);
+      last->~Node();
+      left->count--;
+    } else if (right && right->count > kInnerMinKeys) {
+      new (node->keys() + node->count) Node{std::move(separators[index].data)};
+      node->children[node->count + 1] = right->children[0];
+      node->count++;
+      separators[index].data = std::move(right->keys()->data);
+      eraseSlot(right->keys(), right->count, 0);
+      std::move(right->children + 1, right->children + right->count + 1,
+                right->children);
+      right->count--;
+    } else {
+      if (left) {
+        mergeInners(left, parent, index - 1, node);
+      } else {
+        mergeInners(node, parent, index, right);
+      }
+      rebalanceInner(depth - 1, path);
+    }
+  }
+
+  // Сливает right в left вместе с разделителем index родителя
+  void mergeInners(Inner* left, Inner* parent, size_t index, Inner* right) {
+    new (left->keys() + left->count)
+        Node{std::move(parent->keys()[index].data)};
+    std::uninitialized_move(right->keys(), right->keys() + right->count,
+                            left->keys() + left->count + 1);
+    std::copy(right->children, right->children + right->count + 1,
+              left->children + left->count + 1);
+    left->count += right->count + 1;
+    std::destroy(right->keys(), right->keys() + right->count);
+    destroyInner(right);
+    removeChild(parent, index);
+  }
+
+  void* root_ = nullptr;
+  Leaf* head_ = nullptr;  // самый левый лист
+  Leaf* tail_ = nullptr;  // самый правый лист
+  size_t height_ = 0;     // число уровней внутренних узлов
+  size_t size_ = 0;
+  std::shared_ptr<node_pool> pool_;
+  Compare comp_;
+};
+
+}  // namespace s21
+
+#endif  // S21_BTREE_H
@@ -1,13 +1,26 @@
 #ifndef AVL_TREE_H
 #define AVL_TREE_H
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
 #include <vector>
 namespace s21 {
 
-template <typename Key, typename Value>
+// Compare orders the keys. With a transparent comparator (one that defines
+// is_transparent, such as std::less<>) the lookup functions also accept
+// any type the comparator can compare with Key, without building a Key.
+template <typename Key, typename Value, typename Compare = std::less<Key>>
 class BinaryAVLTree {
+  // Enables an overload only for transparent comparators
+  template <typename C>
+  using Transparent = typename C::is_transparent;
+
  public:
   class TreeIterator;
   class ConstTreeIterator;
+  class NodeHandle;
 
   using key_type = Key;
   using mapped_type = Value;
@@ -17,15 +30,22 @@ class BinaryAVLTree {
   using iterator = TreeIterator;
   using const_iterator = ConstTreeIterator;
   using size_type = size_t;
+  using node_type = NodeHandle;
+  using key_compare = Compare;
 
   typedef struct Node {
     value_type value;
     Node* parent = nullptr;
     Node* left = nullptr;
     Node* right = nullptr;
-    unsigned char height = 0;
+    unsigned char height = 1;
 
     Node(value_type val, Node* par = nullptr);
+
+    // The pair is constructed from args directly inside the node
+    template <typename... Args>
+    explicit Node(std::in_place_t, Args&&... args)
+        : value(std::forward<Args>(args)...) {}
   } Node;
 
   class TreeIterator {
@@ -44,6 +64,8 @@ class BinaryAVLTree {
     bool operator!=(const iterator& other) const;
 
    protected:
+    friend class BinaryAVLTree;
+
     Node* currentNode;
     BinaryAVLTree* ownerTree;
   };
@@ -65,7 +87,39 @@ class BinaryAVLTree {
     const_reference operator*() const;
   };
 
+  // Owns a node extracted from the tree until it is inserted into another
+  // tree; frees the node otherwise
+  class NodeHandle {
+   public:
+    NodeHandle() noexcept = default;
+    NodeHandle(NodeHandle&& other) noexcept;
+    NodeHandle& operator=(NodeHandle&& other) noexcept;
+    ~NodeHandle();
+
+    bool empty() const noexcept { return node == nullptr; }
+    explicit operator bool() const noexcept { return node != nullptr; }
+
+    key_type& key() const { return node->value.first; }
+    mapped_type& mapped() const { return node->value.second; }
+
+   private:
+    friend class BinaryAVLTree;
+
+    explicit NodeHandle(Node* extracted) noexcept : node(extracted) {}
+
+    Node* node = nullptr;
+  };
+
+  // Result of inserting a node handle: the node comes back in `node` if the
+  // key is already present
+  struct insert_return_type {
+    iterator position;
+    bool inserted;
+    node_type node;
+  };
+
   BinaryAVLTree() noexcept;
+  explicit BinaryAVLTree(const Compare& comp);
   BinaryAVLTree(const BinaryAVLTree& other);
   BinaryAVLTree(BinaryAVLTree&& other) noexcept;
   ~BinaryAVLTree();
@@ -73,6 +127,8 @@ class BinaryAVLTree {
   BinaryAVLTree& operator=(const BinaryAVLTree& other);
   BinaryAVLTree& operator=(BinaryAVLTree&& other);
   mapped_type& at(const Key& key);
+  template <typename K, typename C = Compare, typename = Transparent<C>>
+  mapped_type& at(const K& key);
   mapped_type& operator[](const Key& key);
   iterator begin();
   iterator end();
@@ -82,15 +138,37 @@ class BinaryAVLTree {
   std::pair<iterator, bool> insert(const Key& key, const mapped_type& obj);
   std::pair<iterator, bool> insert_or_assign(const Key& key,
                                              const mapped_type& obj);
+  std::pair<iterator, bool> insert_or_assign(const Key& key,
+                                             mapped_type&& obj);
+  template <typename... Args>
+  std::pair<iterator, bool> try_emplace(const Key& key, Args&&... args);
+  template <typename... Args>
+  std::pair<iterator, bool> emplace(Args&&... args);
   template <typename... Args>
   std::vector<std::pair<iterator, bool>> insert_many(Args&&... args);
 
   iterator find(const Key& key);
+  template <typename K, typename C = Compare, typename = Transparent<C>>
+  iterator find(const K& key);
   bool contains(const Key& key);
+  template <typename K, typename C = Compare, typename = Transparent<C>>
+  bool contains(const K& key);
+  size_type count(const Key& key);
+  template <typename K, typename C = Compare, typename = Transparent<C>>
+  size_type count(const K& key);
+  iterator lower_bound(const Key& key);
+  template <typename K, typename C = Compare, typename = Transparent<C>>
+  iterator lower_bound(const K& key);
+  iterator upper_bound(const Key& key);
+  template <typename K, typename C = Compare, typename = Transparent<C>>
+  iterator upper_bound(const K& key);
   void clear();
   void erase(iterator pos);
   void swap(BinaryAVLTree& other);
   void merge(BinaryAVLTree& other);
+  node_type extract(iterator pos);
+  node_type extract(const Key& key);
+  insert_return_type insert(node_type&& handle);
   bool empty();
   size_type size();
   size_type max_size();
@@ -98,22 +176,37 @@ class BinaryAVLTree {
  protected:
   Node* findMin(Node* currentNode);
   Node* findMax(Node* currentNode);
-  Node* getNode(Node* currentNode, const Key& keyToFind);
-  bool setNode(Node* currentNode, const value_type& valueToSet);
-  Node* deleteNode(Node* currentNode, const Key& key);
+  template <typename K>
+  Node* getNode(const K& key);
+  template <typename K>
+  Node* lowerBoundNode(const K& key);
+  template <typename K>
+  Node* upperBoundNode(const K& key);
+  template <typename K>
+  mapped_type& mappedAt(const K& key);
+  Node* findParent(const Key& key, Node*& parentNode, bool& toLeft);
+  void attachLeaf(Node* node, Node* parentNode, bool toLeft);
+  template <typename M>
+  std::pair<iterator, bool> assignOrEmplace(const Key& key, M&& obj);
   void freeNodes(Node* currentNode);
-  size_type getNodesAmount(Node* currentNode);
   Node* cloneTree(Node* currentNode, Node* clonedParentNode);
+  Node* unlinkNode(Node* node);
+  std::pair<Node*, bool> linkNode(Node* node);
 
   // Balancing AVL
-  void rightRotate(Node* currentNode);
-  void leftRotate(Node* currentNode);
-  void balance(Node* currentNode);
+  void replaceChild(Node* parent, Node* oldChild, Node* newChild);
+  Node* rightRotate(Node* currentNode);
+  Node* leftRotate(Node* currentNode);
+  Node* balance(Node* currentNode);
   int getBalance(Node* currentNode);
   int getHeight(Node* currentNode);
   void setHeight(Node* currentNode);
 
   Node* root;
+  // Maintained by every operation that adds or removes nodes, so size()
+  // does not walk the tree
+  size_type nodeCount;
+  Compare compare;
 };
 
 }  // namespace s21
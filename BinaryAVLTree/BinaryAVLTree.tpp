@@ -5,28 +5,39 @@
 
 namespace s21 {
 
-template <typename Key, typename Value>
-BinaryAVLTree<Key, Value>::BinaryAVLTree() noexcept : root(nullptr) {}
+template <typename Key, typename Value, typename Compare>
+BinaryAVLTree<Key, Value, Compare>::BinaryAVLTree() noexcept
+    : root(nullptr), nodeCount(0), compare() {}
 
-template <typename Key, typename Value>
-BinaryAVLTree<Key, Value>::BinaryAVLTree(const BinaryAVLTree& other) {
+template <typename Key, typename Value, typename Compare>
+BinaryAVLTree<Key, Value, Compare>::BinaryAVLTree(const Compare& comp)
+    : root(nullptr), nodeCount(0), compare(comp) {}
+
+template <typename Key, typename Value, typename Compare>
+BinaryAVLTree<Key, Value, Compare>::BinaryAVLTree(const BinaryAVLTree& other)
+    : compare(other.compare) {
   root = cloneTree(other.root, nullptr);
+  nodeCount = other.nodeCount;
 }
 
-template <typename Key, typename Value>
-BinaryAVLTree<Key, Value>::BinaryAVLTree(BinaryAVLTree&& other) noexcept {
+template <typename Key, typename Value, typename Compare>
+BinaryAVLTree<Key, Value, Compare>::BinaryAVLTree(
+    BinaryAVLTree&& other) noexcept
+    : compare(std::move(other.compare)) {
   root = other.root;
+  nodeCount = other.nodeCount;
   other.root = nullptr;
+  other.nodeCount = 0;
 }
 
-template <typename Key, typename Value>
-BinaryAVLTree<Key, Value>::~BinaryAVLTree() {
+template <typename Key, typename Value, typename Compare>
+BinaryAVLTree<Key, Value, Compare>::~BinaryAVLTree() {
   clear();
 }
 
-template <typename Key, typename Value>
-BinaryAVLTree<Key, Value>& BinaryAVLTree<Key, Value>::operator=(
-    const BinaryAVLTree& other) {
+template <typename Key, typename Value, typename Compare>
+BinaryAVLTree<Key, Value, Compare>&
+BinaryAVLTree<Key, Value, Compare>::operator=(const BinaryAVLTree& other) {
   if (this != &other) {
     clear();
     BinaryAVLTree tmp(other);
@@ -36,68 +47,141 @@ BinaryAVLTree<Key, Value>& BinaryAVLTree<Key, Value>::operator=(
   return *this;
 }
 
-template <typename Key, typename Value>
-BinaryAVLTree<Key, Value>& BinaryAVLTree<Key, Value>::operator=(
-    BinaryAVLTree&& other) {
+template <typename Key, typename Value, typename Compare>
+BinaryAVLTree<Key, Value, Compare>&
+BinaryAVLTree<Key, Value, Compare>::operator=(BinaryAVLTree&& other) {
   if (this != &other) {
     clear();
     root = other.root;
+    nodeCount = other.nodeCount;
+    compare = std::move(other.compare);
     other.root = nullptr;
+    other.nodeCount = 0;
   }
 
   return *this;
 }
 
-template <typename Key, typename Value>
-typename BinaryAVLTree<Key, Value>::mapped_type& BinaryAVLTree<Key, Value>::at(
-    const Key& key) {
-  Node* node = getNode(root, key);
+template <typename Key, typename Value, typename Compare>
+typename BinaryAVLTree<Key, Value, Compare>::mapped_type&
+BinaryAVLTree<Key, Value, Compare>::at(const Key& key) {
+  return mappedAt(key);
+}
+
+template <typename Key, typename Value, typename Compare>
+template <typename K, typename C, typename>
+typename BinaryAVLTree<Key, Value, Compare>::mapped_type&
+BinaryAVLTree<Key, Value, Compare>::at(const K& key) {
+  return mappedAt(key);
+}
+
+template <typename Key, typename Value, typename Compare>
+template <typename K>
+typename BinaryAVLTree<Key, Value, Compare>::mapped_type&
+BinaryAVLTree<Key, Value, Compare>::mappedAt(const K& key) {
+  Node* node = getNode(key);
   if (node == nullptr) {
     throw std::out_of_range("The key is not present in the container");
   }
   return node->value.second;
 }
 
-template <typename Key, typename Value>
-typename BinaryAVLTree<Key, Value>::mapped_type&
-BinaryAVLTree<Key, Value>::operator[](const Key& key) {
-  std::pair<iterator, bool> result = insert(std::make_pair(key, mapped_type{}));
-  return (*result.first).second;
+template <typename Key, typename Value, typename Compare>
+typename BinaryAVLTree<Key, Value, Compare>::mapped_type&
+BinaryAVLTree<Key, Value, Compare>::operator[](const Key& key) {
+  return (*try_emplace(key).first).second;
 }
 
-template <typename Key, typename Value>
-std::pair<typename BinaryAVLTree<Key, Value>::iterator, bool>
-BinaryAVLTree<Key, Value>::insert(const value_type& insValue) {
-  std::pair<iterator, bool> result;
-  if (root == nullptr) {
-    root = new Node(insValue);
-    result.first = iterator(root, this);
-    result.second = true;
-  } else {
-    bool setResult = setNode(root, insValue);
-    result = std::make_pair(find(insValue.first), setResult);
+template <typename Key, typename Value, typename Compare>
+std::pair<typename BinaryAVLTree<Key, Value, Compare>::iterator, bool>
+BinaryAVLTree<Key, Value, Compare>::insert(const value_type& insValue) {
+  Node* parentNode;
+  bool toLeft;
+  Node* existing = findParent(insValue.first, parentNode, toLeft);
+  if (existing != nullptr) {
+    return std::make_pair(iterator(existing, this), false);
   }
-  return result;
+  Node* node = new Node(insValue);
+  attachLeaf(node, parentNode, toLeft);
+  return std::make_pair(iterator(node, this), true);
 }
 
-template <typename Key, typename Value>
-std::pair<typename BinaryAVLTree<Key, Value>::iterator, bool>
-BinaryAVLTree<Key, Value>::insert(const Key& key, const mapped_type& obj) {
+template <typename Key, typename Value, typename Compare>
+std::pair<typename BinaryAVLTree<Key, Value, Compare>::iterator, bool>
+BinaryAVLTree<Key, Value, Compare>::insert(const Key& key,
+                                           const mapped_type& obj) {
   return insert(std::make_pair(key, obj));
 }
 
-template <typename Key, typename Value>
-std::pair<typename BinaryAVLTree<Key, Value>::iterator, bool>
-BinaryAVLTree<Key, Value>::insert_or_assign(const Key& key,
-                                            const mapped_type& obj) {
-  root = deleteNode(root, key);
-  return insert(key, obj);
+template <typename Key, typename Value, typename Compare>
+std::pair<typename BinaryAVLTree<Key, Value, Compare>::iterator, bool>
+BinaryAVLTree<Key, Value, Compare>::insert_or_assign(const Key& key,
+                                                     const mapped_type& obj) {
+  return assignOrEmplace(key, obj);
+}
+
+template <typename Key, typename Value, typename Compare>
+std::pair<typename BinaryAVLTree<Key, Value, Compare>::iterator, bool>
+BinaryAVLTree<Key, Value, Compare>::insert_or_assign(const Key& key,
+                                                     mapped_type&& obj) {
+  return assignOrEmplace(key, std::move(obj));
+}
+
+// An existing key keeps its node and only the mapped value is assigned
+template <typename Key, typename Value, typename Compare>
+template <typename M>
+std::pair<typename BinaryAVLTree<Key, Value, Compare>::iterator, bool>
+BinaryAVLTree<Key, Value, Compare>::assignOrEmplace(const Key& key, M&& obj) {
+  Node* parentNode;
+  bool toLeft;
+  Node* existing = findParent(key, parentNode, toLeft);
+  if (existing != nullptr) {
+    existing->value.second = std::forward<M>(obj);
+    return std::make_pair(iterator(existing, this), false);
+  }
+  Node* node = new Node(std::in_place, key, std::forward<M>(obj));
+  attachLeaf(node, parentNode, toLeft);
+  return std::make_pair(iterator(node, this), true);
+}
+
+// The arguments are left untouched when the key is already present
+template <typename Key, typename Value, typename Compare>
+template <typename... Args>
+std::pair<typename BinaryAVLTree<Key, Value, Compare>::iterator, bool>
+BinaryAVLTree<Key, Value, Compare>::try_emplace(const Key& key,
+                                                Args&&... args) {
+  Node* parentNode;
+  bool toLeft;
+  Node* existing = findParent(key, parentNode, toLeft);
+  if (existing != nullptr) {
+    return std::make_pair(iterator(existing, this), false);
+  }
+  Node* node = new Node(std::in_place, std::piecewise_construct,
+                        std::forward_as_tuple(key),
+                        std::forward_as_tuple(std::forward<Args>(args)...));
+  attachLeaf(node, parentNode, toLeft);
+  return std::make_pair(iterator(node, this), true);
+}
+
+// The key is only known once the pair is built, so the node is created
+// first and freed again if the key turns out to be taken
+template <typename Key, typename Value, typename Compare>
+template <typename... Args>
+std::pair<typename BinaryAVLTree<Key, Value, Compare>::iterator, bool>
+BinaryAVLTree<Key, Value, Compare>::emplace(Args&&... args) {
+  Node* node = new Node(std::in_place, std::forward<Args>(args)...);
+  std::pair<Node*, bool> result = linkNode(node);
+  if (!result.second) {
+    delete node;
+  }
+  return std::make_pair(iterator(result.first, this), result.second);
 }
 
-template <typename Key, typename Value>
+template <typename Key, typename Value, typename Compare>
 template <typename... Args>
-std::vector<std::pair<typename BinaryAVLTree<Key, Value>::iterator, bool>>
-BinaryAVLTree<Key, Value>::insert_many(Args&&... args) {
+std::vector<
+    std::pair<typename BinaryAVLTree<Key, Value, Compare>::iterator, bool>>
+BinaryAVLTree<Key, Value, Compare>::insert_many(Args&&... args) {
   std::vector<std::pair<iterator, bool>> resVector;
   for (const auto& arg : {args...}) {
     resVector.push_back(insert(arg));
@@ -106,123 +190,200 @@ BinaryAVLTree<Key, Value>::insert_many(Args&&... args) {
   return resVector;
 }
 
-template <typename Key, typename Value>
-typename BinaryAVLTree<Key, Value>::iterator BinaryAVLTree<Key, Value>::find(
-    const Key& key) {
-  return iterator(getNode(root, key), this);
+template <typename Key, typename Value, typename Compare>
+typename BinaryAVLTree<Key, Value, Compare>::iterator
+BinaryAVLTree<Key, Value, Compare>::find(const Key& key) {
+  return iterator(getNode(key), this);
+}
+
+template <typename Key, typename Value, typename Compare>
+template <typename K, typename C, typename>
+typename BinaryAVLTree<Key, Value, Compare>::iterator
+BinaryAVLTree<Key, Value, Compare>::find(const K& key) {
+  return iterator(getNode(key), this);
+}
+
+template <typename Key, typename Value, typename Compare>
+typename BinaryAVLTree<Key, Value, Compare>::size_type
+BinaryAVLTree<Key, Value, Compare>::count(const Key& key) {
+  return getNode(key) == nullptr ? 0 : 1;
+}
+
+template <typename Key, typename Value, typename Compare>
+template <typename K, typename C, typename>
+typename BinaryAVLTree<Key, Value, Compare>::size_type
+BinaryAVLTree<Key, Value, Compare>::count(const K& key) {
+  return getNode(key) == nullptr ? 0 : 1;
+}
+
+template <typename Key, typename Value, typename Compare>
+typename BinaryAVLTree<Key, Value, Compare>::iterator
+BinaryAVLTree<Key, Value, Compare>::lower_bound(const Key& key) {
+  return iterator(lowerBoundNode(key), this);
+}
+
+template <typename Key, typename Value, typename Compare>
+template <typename K, typename C, typename>
+typename BinaryAVLTree<Key, Value, Compare>::iterator
+BinaryAVLTree<Key, Value, Compare>::lower_bound(const K& key) {
+  return iterator(lowerBoundNode(key), this);
 }
 
-template <typename Key, typename Value>
-void BinaryAVLTree<Key, Value>::clear() {
+template <typename Key, typename Value, typename Compare>
+typename BinaryAVLTree<Key, Value, Compare>::iterator
+BinaryAVLTree<Key, Value, Compare>::upper_bound(const Key& key) {
+  return iterator(upperBoundNode(key), this);
+}
+
+template <typename Key, typename Value, typename Compare>
+template <typename K, typename C, typename>
+typename BinaryAVLTree<Key, Value, Compare>::iterator
+BinaryAVLTree<Key, Value, Compare>::upper_bound(const K& key) {
+  return iterator(upperBoundNode(key), this);
+}
+
+template <typename Key, typename Value, typename Compare>
+void BinaryAVLTree<Key, Value, Compare>::clear() {
   if (root != nullptr) {
     freeNodes(root);
     root = nullptr;
   }
+  nodeCount = 0;
 }
 
-template <typename Key, typename Value>
-bool BinaryAVLTree<Key, Value>::empty() {
+template <typename Key, typename Value, typename Compare>
+bool BinaryAVLTree<Key, Value, Compare>::empty() {
   return root == nullptr;
 }
 
-template <typename Key, typename Value>
-typename BinaryAVLTree<Key, Value>::size_type
-BinaryAVLTree<Key, Value>::size() {
-  return getNodesAmount(root);
+template <typename Key, typename Value, typename Compare>
+typename BinaryAVLTree<Key, Value, Compare>::size_type
+BinaryAVLTree<Key, Value, Compare>::size() {
+  return nodeCount;
 }
 
-template <typename Key, typename Value>
-typename BinaryAVLTree<Key, Value>::size_type
-BinaryAVLTree<Key, Value>::max_size() {
+template <typename Key, typename Value, typename Compare>
+typename BinaryAVLTree<Key, Value, Compare>::size_type
+BinaryAVLTree<Key, Value, Compare>::max_size() {
   return std::numeric_limits<size_type>::max() / sizeof(Node);
 }
 
-template <typename Key, typename Value>
-bool BinaryAVLTree<Key, Value>::setNode(Node* currentNode,
-                                        const value_type& valueToSet) {
-  bool insertResult = false;
-  if (currentNode->value.first > valueToSet.first) {
-    if (currentNode->left == nullptr) {
-      currentNode->left = new Node(valueToSet, currentNode);
-      insertResult = true;
+// Descends once. Returns the node holding the key, or nullptr together
+// with the parent the key belongs under and the side it goes to. Each
+// level costs one comparison; equality is checked once at the bottom
+// against the last node the descent passed on its left.
+template <typename Key, typename Value, typename Compare>
+typename BinaryAVLTree<Key, Value, Compare>::Node*
+BinaryAVLTree<Key, Value, Compare>::findParent(const Key& key,
+                                               Node*& parentNode,
+                                               bool& toLeft) {
+  parentNode = nullptr;
+  toLeft = false;
+  Node* notGreater = nullptr;
+  Node* currentNode = root;
+  while (currentNode != nullptr) {
+    parentNode = currentNode;
+    toLeft = compare(key, currentNode->value.first);
+    if (toLeft) {
+      currentNode = currentNode->left;
     } else {
-      setNode(currentNode->left, valueToSet);
-    }
-  } else if (currentNode->value.first < valueToSet.first) {
-    if (currentNode->right == nullptr) {
-      currentNode->right = new Node(valueToSet, currentNode);
-    } else {
-      setNode(currentNode->right, valueToSet);
-      insertResult = true;
+      notGreater = currentNode;
+      currentNode = currentNode->right;
     }
   }
-
-  setHeight(currentNode);
-  balance(currentNode);
-  return insertResult;
-}
-
-template <typename Key, typename Value>
-typename BinaryAVLTree<Key, Value>::Node* BinaryAVLTree<Key, Value>::getNode(
-    Node* currentNode, const Key& keyToFind) {
-  Node* desiredNode;
-  if (currentNode == nullptr || currentNode->value.first == keyToFind) {
-    desiredNode = currentNode;
-  } else if (currentNode->value.first < keyToFind) {
-    desiredNode = getNode(currentNode->right, keyToFind);
+  if (notGreater != nullptr && !compare(notGreater->value.first, key)) {
+    return notGreater;
+  }
+  return nullptr;
+}
+
+// Hangs a detached node as a leaf at the place found by findParent and
+// retraces upward only while subtree heights keep growing: a rotation or
+// an unchanged height means the levels above are already balanced
+template <typename Key, typename Value, typename Compare>
+void BinaryAVLTree<Key, Value, Compare>::attachLeaf(Node* node,
+                                                    Node* parentNode,
+                                                    bool toLeft) {
+  node->parent = parentNode;
+  node->left = node->right = nullptr;
+  node->height = 1;
+  if (parentNode == nullptr) {
+    root = node;
+  } else if (toLeft) {
+    parentNode->left = node;
   } else {
-    desiredNode = getNode(currentNode->left, keyToFind);
+    parentNode->right = node;
+  }
+  ++nodeCount;
+
+  Node* current = parentNode;
+  while (current != nullptr) {
+    int oldHeight = current->height;
+    setHeight(current);
+    current = balance(current);
+    if (current->height == oldHeight) {
+      break;
+    }
+    current = current->parent;
   }
-  return desiredNode;
 }
 
-template <typename Key, typename Value>
-typename BinaryAVLTree<Key, Value>::Node* BinaryAVLTree<Key, Value>::deleteNode(
-    Node* currentNode, const Key& keyToDelete) {
-  if (currentNode == nullptr) {
-    return nullptr;
+// Lookups take any key type the comparator accepts, so a transparent
+// comparator avoids building a Key. Each level costs one three-way
+// comparison (two comparator calls); both are made unconditionally so the
+// child is picked with a conditional move rather than a branch.
+template <typename Key, typename Value, typename Compare>
+template <typename K>
+typename BinaryAVLTree<Key, Value, Compare>::Node*
+BinaryAVLTree<Key, Value, Compare>::getNode(const K& key) {
+  Node* currentNode = root;
+  while (currentNode != nullptr) {
+    bool less = compare(key, currentNode->value.first);
+    bool greater = compare(currentNode->value.first, key);
+    if (less == greater) {
+      return currentNode;
+    }
+    currentNode = greater ? currentNode->right : currentNode->left;
   }
+  return nullptr;
+}
 
-  if (currentNode->value.first > keyToDelete) {
-    currentNode->left = deleteNode(currentNode->left, keyToDelete);
-  } else if (currentNode->value.first < keyToDelete) {
-    currentNode->right = deleteNode(currentNode->right, keyToDelete);
-  } else {
-    Node* parentNode = currentNode->parent;
-    Node* rightNode = currentNode->right;
-    Node* leftNode = currentNode->left;
-    if (currentNode->left == nullptr && currentNode->right == nullptr) {
-      delete currentNode;
-      currentNode = nullptr;
-    } else if (currentNode->left == nullptr) {
-      delete currentNode;
-      currentNode = rightNode;
-      if (currentNode != nullptr) {
-        currentNode->parent = parentNode;
-      }
-    } else if (currentNode->right == nullptr) {
-      delete currentNode;
-      currentNode = leftNode;
-      if (currentNode != nullptr) {
-        currentNode->parent = parentNode;
-      }
+template <typename Key, typename Value, typename Compare>
+template <typename K>
+typename BinaryAVLTree<Key, Value, Compare>::Node*
+BinaryAVLTree<Key, Value, Compare>::lowerBoundNode(const K& key) {
+  Node* result = nullptr;
+  Node* currentNode = root;
+  while (currentNode != nullptr) {
+    if (compare(currentNode->value.first, key)) {
+      currentNode = currentNode->right;
     } else {
-      Node* minNode = findMin(currentNode->right);
-      currentNode->value = minNode->value;
-      currentNode->right = deleteNode(currentNode->right, minNode->value.first);
+      result = currentNode;
+      currentNode = currentNode->left;
     }
   }
+  return result;
+}
 
-  if (currentNode != nullptr) {
-    setHeight(currentNode);
-    balance(currentNode);
+template <typename Key, typename Value, typename Compare>
+template <typename K>
+typename BinaryAVLTree<Key, Value, Compare>::Node*
+BinaryAVLTree<Key, Value, Compare>::upperBoundNode(const K& key) {
+  Node* result = nullptr;
+  Node* currentNode = root;
+  while (currentNode != nullptr) {
+    if (compare(key, currentNode->value.first)) {
+      result = currentNode;
+      currentNode = currentNode->left;
+    } else {
+      currentNode = currentNode->right;
+    }
   }
-
-  return currentNode;
+  return result;
 }
 
-template <typename Key, typename Value>
-void BinaryAVLTree<Key, Value>::freeNodes(Node* currentNode) {
+template <typename Key, typename Value, typename Compare>
+void BinaryAVLTree<Key, Value, Compare>::freeNodes(Node* currentNode) {
   if (currentNode != nullptr) {
     freeNodes(currentNode->right);
     freeNodes(currentNode->left);
@@ -230,59 +391,109 @@ void BinaryAVLTree<Key, Value>::freeNodes(Node* currentNode) {
   }
 }
 
-template <typename Key, typename Value>
-typename BinaryAVLTree<Key, Value>::size_type
-BinaryAVLTree<Key, Value>::getNodesAmount(Node* currentNode) {
-  if (currentNode == nullptr) {
-    return 0;
-  }
-
-  size_type leftSubTreeSize = getNodesAmount(currentNode->left);
-  size_type rightSubTreeSize = getNodesAmount(currentNode->right);
-
-  return 1 + leftSubTreeSize + rightSubTreeSize;
-}
-
-template <typename Key, typename Value>
-typename BinaryAVLTree<Key, Value>::Node* BinaryAVLTree<Key, Value>::cloneTree(
-    Node* currentNode, Node* clonedParentNode) {
+template <typename Key, typename Value, typename Compare>
+typename BinaryAVLTree<Key, Value, Compare>::Node*
+BinaryAVLTree<Key, Value, Compare>::cloneTree(Node* currentNode,
+                                              Node* clonedParentNode) {
   if (currentNode == nullptr) {
     return nullptr;
   }
 
   Node* clonedNode = new Node(currentNode->value, clonedParentNode);
+  clonedNode->height = currentNode->height;
   clonedNode->left = cloneTree(currentNode->left, clonedNode);
   clonedNode->right = cloneTree(currentNode->right, clonedNode);
 
   return clonedNode;
 }
 
-template <typename Key, typename Value>
-typename BinaryAVLTree<Key, Value>::iterator
-BinaryAVLTree<Key, Value>::begin() {
+// Takes the node out of the tree without freeing it. A node with two
+// children is replaced by its successor, so no other node changes its
+// value and iterators to the rest of the tree stay valid.
+template <typename Key, typename Value, typename Compare>
+typename BinaryAVLTree<Key, Value, Compare>::Node*
+BinaryAVLTree<Key, Value, Compare>::unlinkNode(Node* node) {
+  Node* rebalanceFrom;
+  if (node->left != nullptr && node->right != nullptr) {
+    Node* successor = findMin(node->right);
+    if (successor->parent == node) {
+      rebalanceFrom = successor;
+    } else {
+      rebalanceFrom = successor->parent;
+      rebalanceFrom->left = successor->right;
+      if (successor->right != nullptr) {
+        successor->right->parent = rebalanceFrom;
+      }
+      successor->right = node->right;
+      successor->right->parent = successor;
+    }
+    successor->left = node->left;
+    successor->left->parent = successor;
+    replaceChild(node->parent, node, successor);
+    successor->parent = node->parent;
+  } else {
+    Node* childNode = node->left != nullptr ? node->left : node->right;
+    if (childNode != nullptr) {
+      childNode->parent = node->parent;
+    }
+    replaceChild(node->parent, node, childNode);
+    rebalanceFrom = node->parent;
+  }
+
+  for (Node* current = rebalanceFrom; current != nullptr;
+       current = current->parent) {
+    setHeight(current);
+    current = balance(current);
+  }
+
+  node->parent = node->left = node->right = nullptr;
+  node->height = 0;
+  --nodeCount;
+  return node;
+}
+
+// Links a detached node as a new leaf. Returns the node itself, or the node
+// with an equal key, in which case the detached node is left untouched.
+template <typename Key, typename Value, typename Compare>
+std::pair<typename BinaryAVLTree<Key, Value, Compare>::Node*, bool>
+BinaryAVLTree<Key, Value, Compare>::linkNode(Node* node) {
+  Node* parentNode;
+  bool toLeft;
+  Node* existing = findParent(node->value.first, parentNode, toLeft);
+  if (existing != nullptr) {
+    return std::make_pair(existing, false);
+  }
+  attachLeaf(node, parentNode, toLeft);
+  return std::make_pair(node, true);
+}
+
+template <typename Key, typename Value, typename Compare>
+typename BinaryAVLTree<Key, Value, Compare>::iterator
+BinaryAVLTree<Key, Value, Compare>::begin() {
   return iterator(findMin(root), this);
 }
 
-template <typename Key, typename Value>
-typename BinaryAVLTree<Key, Value>::iterator BinaryAVLTree<Key, Value>::end() {
+template <typename Key, typename Value, typename Compare>
+typename BinaryAVLTree<Key, Value, Compare>::iterator
+BinaryAVLTree<Key, Value, Compare>::end() {
   return iterator(nullptr, this);
 }
 
-template <typename Key, typename Value>
-typename BinaryAVLTree<Key, Value>::const_iterator
-BinaryAVLTree<Key, Value>::cbegin() {
+template <typename Key, typename Value, typename Compare>
+typename BinaryAVLTree<Key, Value, Compare>::const_iterator
+BinaryAVLTree<Key, Value, Compare>::cbegin() {
   return const_iterator(findMin(root), this);
 }
 
-template <typename Key, typename Value>
-typename BinaryAVLTree<Key, Value>::const_iterator
-BinaryAVLTree<Key, Value>::cend() {
+template <typename Key, typename Value, typename Compare>
+typename BinaryAVLTree<Key, Value, Compare>::const_iterator
+BinaryAVLTree<Key, Value, Compare>::cend() {
   return const_iterator(nullptr, this);
 }
 
-template <typename Key, typename Value>
-typename BinaryAVLTree<Key, Value>::Node* BinaryAVLTree<Key, Value>::findMin(
-    Node* currentNode) {
+template <typename Key, typename Value, typename Compare>
+typename BinaryAVLTree<Key, Value, Compare>::Node*
+BinaryAVLTree<Key, Value, Compare>::findMin(Node* currentNode) {
   Node* minNode;
   if (currentNode == nullptr) {
     minNode = nullptr;
@@ -295,9 +506,9 @@ typename BinaryAVLTree<Key, Value>::Node* BinaryAVLTree<Key, Value>::findMin(
   return minNode;
 }
 
-template <typename Key, typename Value>
-typename BinaryAVLTree<Key, Value>::Node* BinaryAVLTree<Key, Value>::findMax(
-    Node* currentNode) {
+template <typename Key, typename Value, typename Compare>
+typename BinaryAVLTree<Key, Value, Compare>::Node*
+BinaryAVLTree<Key, Value, Compare>::findMax(Node* currentNode) {
   Node* maxNode;
   if (currentNode == nullptr) {
     maxNode = nullptr;
@@ -310,50 +521,113 @@ typename BinaryAVLTree<Key, Value>::Node* BinaryAVLTree<Key, Value>::findMax(
   return maxNode;
 }
 
-template <typename Key, typename Value>
-bool BinaryAVLTree<Key, Value>::contains(const Key& key) {
-  return !(getNode(root, key) == nullptr);
+template <typename Key, typename Value, typename Compare>
+bool BinaryAVLTree<Key, Value, Compare>::contains(const Key& key) {
+  return getNode(key) != nullptr;
 }
 
-template <typename Key, typename Value>
-void BinaryAVLTree<Key, Value>::erase(iterator pos) {
-  if (root == nullptr) {
+template <typename Key, typename Value, typename Compare>
+template <typename K, typename C, typename>
+bool BinaryAVLTree<Key, Value, Compare>::contains(const K& key) {
+  return getNode(key) != nullptr;
+}
+
+template <typename Key, typename Value, typename Compare>
+void BinaryAVLTree<Key, Value, Compare>::erase(iterator pos) {
+  if (pos.currentNode == nullptr) {
     return;
   }
-  root = deleteNode(root, (*pos).first);
+  delete unlinkNode(pos.currentNode);
 }
 
-template <typename Key, typename Value>
-void BinaryAVLTree<Key, Value>::swap(BinaryAVLTree& other) {
+template <typename Key, typename Value, typename Compare>
+void BinaryAVLTree<Key, Value, Compare>::swap(BinaryAVLTree& other) {
   std::swap(root, other.root);
+  std::swap(nodeCount, other.nodeCount);
+  std::swap(compare, other.compare);
 }
 
-template <typename Key, typename Value>
-void BinaryAVLTree<Key, Value>::merge(BinaryAVLTree& other) {
+// Moves nodes, not values: every node of other is detached first and then
+// linked either into this tree or, if the key is already here, back into
+// other. Other cannot be walked while duplicates are linked back into it,
+// so it is flattened into a list threaded through the right pointers
+// first, which needs no extra memory.
+template <typename Key, typename Value, typename Compare>
+void BinaryAVLTree<Key, Value, Compare>::merge(BinaryAVLTree& other) {
   if (this == &other) {
     return;
   }
 
-  BinaryAVLTree copyOther(other);
-  for (auto iter{copyOther.begin()}; iter != copyOther.end(); ++iter) {
-    std::pair<iterator, bool> res = insert(*iter);
-    if (res.second) other.erase(res.first);
+  Node* list = nullptr;
+  Node* currentNode = other.root;
+  while (currentNode != nullptr) {
+    if (currentNode->left != nullptr) {
+      Node* leftNode = currentNode->left;
+      currentNode->left = leftNode->right;
+      leftNode->right = currentNode;
+      currentNode = leftNode;
+    } else {
+      Node* nextNode = currentNode->right;
+      currentNode->right = list;
+      list = currentNode;
+      currentNode = nextNode;
+    }
+  }
+  other.root = nullptr;
+  other.nodeCount = 0;
+
+  while (list != nullptr) {
+    Node* node = list;
+    list = list->right;
+    node->parent = node->left = node->right = nullptr;
+    if (!linkNode(node).second) {
+      other.linkNode(node);
+    }
+  }
+}
+
+template <typename Key, typename Value, typename Compare>
+typename BinaryAVLTree<Key, Value, Compare>::node_type
+BinaryAVLTree<Key, Value, Compare>::extract(iterator pos) {
+  if (pos.currentNode == nullptr) {
+    return node_type();
   }
+  return node_type(unlinkNode(pos.currentNode));
+}
+
+template <typename Key, typename Value, typename Compare>
+typename BinaryAVLTree<Key, Value, Compare>::node_type
+BinaryAVLTree<Key, Value, Compare>::extract(const Key& key) {
+  Node* node = getNode(key);
+  return node == nullptr ? node_type() : node_type(unlinkNode(node));
+}
+
+template <typename Key, typename Value, typename Compare>
+typename BinaryAVLTree<Key, Value, Compare>::insert_return_type
+BinaryAVLTree<Key, Value, Compare>::insert(node_type&& handle) {
+  if (handle.empty()) {
+    return {end(), false, node_type()};
+  }
+  std::pair<Node*, bool> result = linkNode(handle.node);
+  if (result.second) {
+    handle.node = nullptr;
+  }
+  return {iterator(result.first, this), result.second, std::move(handle)};
 }
 
 // Iterator
-template <typename Key, typename Value>
-BinaryAVLTree<Key, Value>::TreeIterator::TreeIterator() noexcept
+template <typename Key, typename Value, typename Compare>
+BinaryAVLTree<Key, Value, Compare>::TreeIterator::TreeIterator() noexcept
     : currentNode(nullptr) {}
 
-template <typename Key, typename Value>
-BinaryAVLTree<Key, Value>::TreeIterator::TreeIterator(Node* currNode,
-                                                      BinaryAVLTree* ownerTree)
+template <typename Key, typename Value, typename Compare>
+BinaryAVLTree<Key, Value, Compare>::TreeIterator::TreeIterator(
+    Node* currNode, BinaryAVLTree* ownerTree)
     : currentNode(currNode), ownerTree(ownerTree) {}
 
-template <typename Key, typename Value>
-typename BinaryAVLTree<Key, Value>::iterator&
-BinaryAVLTree<Key, Value>::TreeIterator::operator++() {
+template <typename Key, typename Value, typename Compare>
+typename BinaryAVLTree<Key, Value, Compare>::iterator&
+BinaryAVLTree<Key, Value, Compare>::TreeIterator::operator++() {
   if (currentNode != nullptr) {
     // If currentNode == nullptr do nothing
     if (currentNode->right) {
@@ -377,17 +651,17 @@ BinaryAVLTree<Key, Value>::TreeIterator::operator++() {
   return *this;
 }
 
-template <typename Key, typename Value>
-typename BinaryAVLTree<Key, Value>::iterator
-BinaryAVLTree<Key, Value>::TreeIterator::operator++(int) {
+template <typename Key, typename Value, typename Compare>
+typename BinaryAVLTree<Key, Value, Compare>::iterator
+BinaryAVLTree<Key, Value, Compare>::TreeIterator::operator++(int) {
   iterator tmp = *this;
   operator++();
   return tmp;
 }
 
-template <typename Key, typename Value>
-typename BinaryAVLTree<Key, Value>::iterator&
-BinaryAVLTree<Key, Value>::TreeIterator::operator--() {
+template <typename Key, typename Value, typename Compare>
+typename BinaryAVLTree<Key, Value, Compare>::iterator&
+BinaryAVLTree<Key, Value, Compare>::TreeIterator::operator--() {
   if (currentNode == nullptr) {
     // Set the last node
     currentNode = ownerTree->findMax(ownerTree->root);
@@ -410,17 +684,17 @@ BinaryAVLTree<Key, Value>::TreeIterator::operator--() {
   return *this;
 }
 
-template <typename Key, typename Value>
-typename BinaryAVLTree<Key, Value>::iterator
-BinaryAVLTree<Key, Value>::TreeIterator::operator--(int) {
+template <typename Key, typename Value, typename Compare>
+typename BinaryAVLTree<Key, Value, Compare>::iterator
+BinaryAVLTree<Key, Value, Compare>::TreeIterator::operator--(int) {
   iterator tmp = *this;
   operator--();
   return tmp;
 }
 
-template <typename Key, typename Value>
-typename BinaryAVLTree<Key, Value>::reference
-BinaryAVLTree<Key, Value>::TreeIterator::operator*() const {
+template <typename Key, typename Value, typename Compare>
+typename BinaryAVLTree<Key, Value, Compare>::reference
+BinaryAVLTree<Key, Value, Compare>::TreeIterator::operator*() const {
   if (currentNode == nullptr) {
     static value_type emptyValue{};
     return emptyValue;
@@ -428,143 +702,175 @@ BinaryAVLTree<Key, Value>::TreeIterator::operator*() const {
   return currentNode->value;
 }
 
-template <typename Key, typename Value>
-bool BinaryAVLTree<Key, Value>::TreeIterator::operator==(
+template <typename Key, typename Value, typename Compare>
+bool BinaryAVLTree<Key, Value, Compare>::TreeIterator::operator==(
     const iterator& other) const {
   return currentNode == other.currentNode;
 }
 
-template <typename Key, typename Value>
-bool BinaryAVLTree<Key, Value>::TreeIterator::operator!=(
+template <typename Key, typename Value, typename Compare>
+bool BinaryAVLTree<Key, Value, Compare>::TreeIterator::operator!=(
     const iterator& other) const {
   return currentNode != other.currentNode;
 }
 
 // Const iterator
-template <typename Key, typename Value>
-typename BinaryAVLTree<Key, Value>::const_iterator&
-BinaryAVLTree<Key, Value>::ConstTreeIterator::operator++() {
+template <typename Key, typename Value, typename Compare>
+typename BinaryAVLTree<Key, Value, Compare>::const_iterator&
+BinaryAVLTree<Key, Value, Compare>::ConstTreeIterator::operator++() {
   TreeIterator::operator++();
   return *this;
 }
 
-template <typename Key, typename Value>
-typename BinaryAVLTree<Key, Value>::const_iterator
-BinaryAVLTree<Key, Value>::ConstTreeIterator::operator++(int) {
+template <typename Key, typename Value, typename Compare>
+typename BinaryAVLTree<Key, Value, Compare>::const_iterator
+BinaryAVLTree<Key, Value, Compare>::ConstTreeIterator::operator++(int) {
   ConstTreeIterator constTmp = TreeIterator::operator++(0);
   return constTmp;
 }
 
-template <typename Key, typename Value>
-typename BinaryAVLTree<Key, Value>::const_iterator&
-BinaryAVLTree<Key, Value>::ConstTreeIterator::operator--() {
+template <typename Key, typename Value, typename Compare>
+typename BinaryAVLTree<Key, Value, Compare>::const_iterator&
+BinaryAVLTree<Key, Value, Compare>::ConstTreeIterator::operator--() {
   TreeIterator::operator--();
   return *this;
 }
 
-template <typename Key, typename Value>
-typename BinaryAVLTree<Key, Value>::const_iterator
-BinaryAVLTree<Key, Value>::ConstTreeIterator::operator--(int) {
+template <typename Key, typename Value, typename Compare>
+typename BinaryAVLTree<Key, Value, Compare>::const_iterator
+BinaryAVLTree<Key, Value, Compare>::ConstTreeIterator::operator--(int) {
   const_iterator constTmp = TreeIterator::operator--(0);
   return constTmp;
 }
 
-template <typename Key, typename Value>
-typename BinaryAVLTree<Key, Value>::const_reference
-BinaryAVLTree<Key, Value>::ConstTreeIterator::operator*() const {
+template <typename Key, typename Value, typename Compare>
+typename BinaryAVLTree<Key, Value, Compare>::const_reference
+BinaryAVLTree<Key, Value, Compare>::ConstTreeIterator::operator*() const {
   const_reference constVal = TreeIterator::operator*();
   return constVal;
 }
 
 // Node
-template <typename Key, typename Value>
-BinaryAVLTree<Key, Value>::Node::Node(value_type val, Node* par)
-    : value(val), parent(par){};
+template <typename Key, typename Value, typename Compare>
+BinaryAVLTree<Key, Value, Compare>::Node::Node(value_type val, Node* par)
+    : value(std::move(val)), parent(par){};
+
+// Node handle
+template <typename Key, typename Value, typename Compare>
+BinaryAVLTree<Key, Value, Compare>::NodeHandle::NodeHandle(
+    NodeHandle&& other) noexcept
+    : node(other.node) {
+  other.node = nullptr;
+}
+
+template <typename Key, typename Value, typename Compare>
+typename BinaryAVLTree<Key, Value, Compare>::NodeHandle&
+BinaryAVLTree<Key, Value, Compare>::NodeHandle::operator=(
+    NodeHandle&& other) noexcept {
+  if (this != &other) {
+    delete node;
+    node = other.node;
+    other.node = nullptr;
+  }
+  return *this;
+}
+
+template <typename Key, typename Value, typename Compare>
+BinaryAVLTree<Key, Value, Compare>::NodeHandle::~NodeHandle() {
+  delete node;
+}
 
 // Balancing AVL
-template <typename Key, typename Value>
-int BinaryAVLTree<Key, Value>::getHeight(Node* currentNode) {
+template <typename Key, typename Value, typename Compare>
+int BinaryAVLTree<Key, Value, Compare>::getHeight(Node* currentNode) {
   return currentNode == nullptr ? 0 : currentNode->height;
 }
 
-template <typename Key, typename Value>
-int BinaryAVLTree<Key, Value>::getBalance(Node* currentNode) {
+template <typename Key, typename Value, typename Compare>
+int BinaryAVLTree<Key, Value, Compare>::getBalance(Node* currentNode) {
   return currentNode == nullptr
              ? 0
              : getHeight(currentNode->right) - getHeight(currentNode->left);
 }
 
-template <typename Key, typename Value>
-void BinaryAVLTree<Key, Value>::setHeight(Node* currentNode) {
+template <typename Key, typename Value, typename Compare>
+void BinaryAVLTree<Key, Value, Compare>::setHeight(Node* currentNode) {
   currentNode->height =
       std::max(getHeight(currentNode->left), getHeight(currentNode->right)) + 1;
 }
 
-template <typename Key, typename Value>
-void BinaryAVLTree<Key, Value>::rightRotate(Node* currentNode) {
-  Node* new_left = currentNode->left->left;
-  Node* new_right_right = currentNode->right;
-  Node* new_right_left = currentNode->left->right;
-
-  std::swap(currentNode->value, currentNode->left->value);
-  currentNode->right = currentNode->left;
+// Puts newChild where oldChild hung under parent, or at the root
+template <typename Key, typename Value, typename Compare>
+void BinaryAVLTree<Key, Value, Compare>::replaceChild(Node* parent,
+                                                      Node* oldChild,
+                                                      Node* newChild) {
+  if (parent == nullptr) {
+    root = newChild;
+  } else if (parent->left == oldChild) {
+    parent->left = newChild;
+  } else {
+    parent->right = newChild;
+  }
+}
 
-  currentNode->left = new_left;
+// Rotations relink nodes and leave every value where it is, so pointers
+// and iterators to elements survive rebalancing. Each returns the node
+// that now roots the rotated subtree.
+template <typename Key, typename Value, typename Compare>
+typename BinaryAVLTree<Key, Value, Compare>::Node*
+BinaryAVLTree<Key, Value, Compare>::rightRotate(Node* currentNode) {
+  Node* pivot = currentNode->left;
+  currentNode->left = pivot->right;
   if (currentNode->left) {
     currentNode->left->parent = currentNode;
   }
 
-  currentNode->right->left = new_right_left;
-  if (currentNode->right->left) {
-    currentNode->right->left->parent = currentNode->right;
-  }
-
-  currentNode->right->right = new_right_right;
-  if (currentNode->right->right) {
-    currentNode->right->right->parent = currentNode->right;
-  }
+  replaceChild(currentNode->parent, currentNode, pivot);
+  pivot->parent = currentNode->parent;
+  pivot->right = currentNode;
+  currentNode->parent = pivot;
 
-  setHeight(currentNode->right);
   setHeight(currentNode);
+  setHeight(pivot);
+  return pivot;
 }
 
-template <typename Key, typename Value>
-void BinaryAVLTree<Key, Value>::leftRotate(Node* currentNode) {
-  Node* new_right = currentNode->right->right;
-  Node* new_left_left = currentNode->left;
-  Node* new_left_right = currentNode->right->left;
-
-  std::swap(currentNode->value, currentNode->right->value);
-  currentNode->left = currentNode->right;
-
-  currentNode->right = new_right;
+template <typename Key, typename Value, typename Compare>
+typename BinaryAVLTree<Key, Value, Compare>::Node*
+BinaryAVLTree<Key, Value, Compare>::leftRotate(Node* currentNode) {
+  Node* pivot = currentNode->right;
+  currentNode->right = pivot->left;
   if (currentNode->right) {
     currentNode->right->parent = currentNode;
   }
 
-  currentNode->left->right = new_left_right;
-  if (currentNode->left->right) {
-    currentNode->left->right->parent = currentNode->left;
-  }
-
-  currentNode->left->left = new_left_left;
-  if (currentNode->left->left) {
-    currentNode->left->left->parent = currentNode->left;
-  }
+  replaceChild(currentNode->parent, currentNode, pivot);
+  pivot->parent = currentNode->parent;
+  pivot->left = currentNode;
+  currentNode->parent = pivot;
 
-  setHeight(currentNode->left);
   setHeight(currentNode);
+  setHeight(pivot);
+  return pivot;
 }
 
-template <typename Key, typename Value>
-void BinaryAVLTree<Key, Value>::balance(Node* currentNode) {
+// Returns the root of the subtree after rebalancing
+template <typename Key, typename Value, typename Compare>
+typename BinaryAVLTree<Key, Value, Compare>::Node*
+BinaryAVLTree<Key, Value, Compare>::balance(Node* currentNode) {
   int balance = getBalance(currentNode);
   if (balance == -2) {
-    if (getBalance(currentNode->left) == 1) leftRotate(currentNode->left);
-    rightRotate(currentNode);
-  } else if (balance == 2) {
-    if (getBalance(currentNode->right) == -1) rightRotate(currentNode->right);
-    leftRotate(currentNode);
+    if (getBalance(currentNode->left) == 1) {
+      leftRotate(currentNode->left);
+    }
+    return rightRotate(currentNode);
   }
-};
+  if (balance == 2) {
+    if (getBalance(currentNode->right) == -1) {
+      rightRotate(currentNode->right);
+    }
+    return leftRotate(currentNode);
+  }
+  return currentNode;
+}
 }  // namespace s21
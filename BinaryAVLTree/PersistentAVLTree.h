@@ -0,0 +1,112 @@
+#ifndef PERSISTENT_AVL_TREE_H
+#define PERSISTENT_AVL_TREE_H
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+namespace s21 {
+
+// Immutable AVL tree. insert, insert_or_assign and erase leave the tree
+// untouched and return a new version that copies only the nodes on the
+// path to the change (O(log n) of them) and shares every other node.
+// Nodes are reference counted, so a copy of the tree is an O(1) snapshot
+// and a node is freed once no version refers to it. Compare orders the
+// keys, as in BinaryAVLTree.
+template <typename Key, typename Value, typename Compare = std::less<Key>>
+class PersistentAVLTree {
+ public:
+  class ConstTreeIterator;
+  struct Node;
+
+  using key_type = Key;
+  using mapped_type = Value;
+  using value_type = std::pair<const key_type, mapped_type>;
+  using const_reference = const value_type&;
+  using const_iterator = ConstTreeIterator;
+  using size_type = size_t;
+  using key_compare = Compare;
+  using NodePtr = std::shared_ptr<const Node>;
+
+  struct Node {
+    value_type value;
+    NodePtr left;
+    NodePtr right;
+    unsigned char height;
+
+    Node(value_type val, NodePtr lhs, NodePtr rhs);
+  };
+
+  // Forward iterator. Nodes have no parent pointers because a node may
+  // belong to many versions, so the iterator keeps the current node and
+  // the ancestors it still has to visit
+  class ConstTreeIterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = PersistentAVLTree::value_type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const value_type*;
+    using reference = const value_type&;
+
+    ConstTreeIterator() = default;
+
+    const_iterator& operator++();
+    const_iterator operator++(int);
+
+    const_reference operator*() const;
+    const value_type* operator->() const;
+    bool operator==(const const_iterator& other) const;
+    bool operator!=(const const_iterator& other) const;
+
+   private:
+    friend class PersistentAVLTree;
+
+    void pushLeft(const Node* node);
+
+    std::vector<const Node*> path;
+  };
+
+  PersistentAVLTree() = default;
+  explicit PersistentAVLTree(const Compare& comp);
+
+  const_iterator begin() const;
+  const_iterator end() const;
+  const mapped_type& at(const Key& key) const;
+  const value_type* find(const Key& key) const;
+  bool contains(const Key& key) const;
+  bool empty() const;
+  size_type size() const;
+  const NodePtr& getRoot() const;
+  key_compare key_comp() const;
+
+  // Each returns the new version; the same version when nothing changes
+  PersistentAVLTree insert(const Key& key, const mapped_type& obj) const;
+  PersistentAVLTree insert_or_assign(const Key& key,
+                                     const mapped_type& obj) const;
+  PersistentAVLTree erase(const Key& key) const;
+
+ protected:
+  static NodePtr makeNode(const value_type& value, NodePtr left,
+                          NodePtr right);
+  static NodePtr balance(const value_type& value, NodePtr left,
+                         NodePtr right);
+  static int getHeight(const NodePtr& node);
+  static const Node* findMin(const Node* node);
+  static NodePtr removeMin(const NodePtr& node);
+
+  NodePtr setNode(const NodePtr& node, const Key& key,
+                  const mapped_type& obj, bool assign, bool& changed) const;
+  NodePtr deleteNode(const NodePtr& node, const Key& key) const;
+  PersistentAVLTree withRoot(NodePtr newRoot, size_type newSize) const;
+
+  NodePtr root;
+  size_type count = 0;
+  Compare compare;
+};
+
+}  // namespace s21
+
+#include "PersistentAVLTree.tpp"
+
+#endif
@@ -0,0 +1,295 @@
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#include "PersistentAVLTree.h"
+
+namespace s21 {
+
+template <typename Key, typename Value, typename Compare>
+PersistentAVLTree<Key, Value, Compare>::PersistentAVLTree(const Compare& comp)
+    : compare(comp) {}
+
+template <typename Key, typename Value, typename Compare>
+PersistentAVLTree<Key, Value, Compare>::Node::Node(value_type val,
+                                                   NodePtr lhs, NodePtr rhs)
+    : value(std::move(val)), left(std::move(lhs)), right(std::move(rhs)) {
+  height = static_cast<unsigned char>(
+      std::max(getHeight(left), getHeight(right)) + 1);
+}
+
+template <typename Key, typename Value, typename Compare>
+typename PersistentAVLTree<Key, Value, Compare>::const_iterator&
+PersistentAVLTree<Key, Value, Compare>::ConstTreeIterator::operator++() {
+  const Node* node = path.back();
+  path.pop_back();
+  pushLeft(node->right.get());
+  return *this;
+}
+
+template <typename Key, typename Value, typename Compare>
+typename PersistentAVLTree<Key, Value, Compare>::const_iterator
+PersistentAVLTree<Key, Value, Compare>::ConstTreeIterator::operator++(int) {
+  const_iterator old = *this;
+  ++*this;
+  return old;
+}
+
+template <typename Key, typename Value, typename Compare>
+typename PersistentAVLTree<Key, Value, Compare>::const_reference
+PersistentAVLTree<Key, Value, Compare>::ConstTreeIterator::operator*() const {
+  return path.back()->value;
+}
+
+template <typename Key, typename Value, typename Compare>
+const typename PersistentAVLTree<Key, Value, Compare>::value_type*
+PersistentAVLTree<Key, Value, Compare>::ConstTreeIterator::operator->() const {
+  return &path.back()->value;
+}
+
+template <typename Key, typename Value, typename Compare>
+bool PersistentAVLTree<Key, Value, Compare>::ConstTreeIterator::operator==(
+    const const_iterator& other) const {
+  const Node* current = path.empty() ? nullptr : path.back();
+  const Node* otherCurrent = other.path.empty() ? nullptr : other.path.back();
+  return current == otherCurrent;
+}
+
+template <typename Key, typename Value, typename Compare>
+bool PersistentAVLTree<Key, Value, Compare>::ConstTreeIterator::operator!=(
+    const const_iterator& other) const {
+  return !(*this == other);
+}
+
+template <typename Key, typename Value, typename Compare>
+void PersistentAVLTree<Key, Value, Compare>::ConstTreeIterator::pushLeft(
+    const Node* node) {
+  for (; node; node = node->left.get()) {
+    path.push_back(node);
+  }
+}
+
+template <typename Key, typename Value, typename Compare>
+typename PersistentAVLTree<Key, Value, Compare>::const_iterator
+PersistentAVLTree<Key, Value, Compare>::begin() const {
+  const_iterator it;
+  it.pushLeft(root.get());
+  return it;
+}
+
+template <typename Key, typename Value, typename Compare>
+typename PersistentAVLTree<Key, Value, Compare>::const_iterator
+PersistentAVLTree<Key, Value, Compare>::end() const {
+  return const_iterator();
+}
+
+template <typename Key, typename Value, typename Compare>
+const typename PersistentAVLTree<Key, Value, Compare>::mapped_type&
+PersistentAVLTree<Key, Value, Compare>::at(const Key& key) const {
+  const value_type* value = find(key);
+  if (value == nullptr) {
+    throw std::out_of_range("The key is not present in the container");
+  }
+  return value->second;
+}
+
+template <typename Key, typename Value, typename Compare>
+const typename PersistentAVLTree<Key, Value, Compare>::value_type*
+PersistentAVLTree<Key, Value, Compare>::find(const Key& key) const {
+  const Node* node = root.get();
+  while (node != nullptr) {
+    if (compare(key, node->value.first)) {
+      node = node->left.get();
+    } else if (compare(node->value.first, key)) {
+      node = node->right.get();
+    } else {
+      return &node->value;
+    }
+  }
+  return nullptr;
+}
+
+template <typename Key, typename Value, typename Compare>
+bool PersistentAVLTree<Key, Value, Compare>::contains(const Key& key) const {
+  return find(key) != nullptr;
+}
+
+template <typename Key, typename Value, typename Compare>
+bool PersistentAVLTree<Key, Value, Compare>::empty() const {
+  return count == 0;
+}
+
+template <typename Key, typename Value, typename Compare>
+typename PersistentAVLTree<Key, Value, Compare>::size_type
+PersistentAVLTree<Key, Value, Compare>::size() const {
+  return count;
+}
+
+template <typename Key, typename Value, typename Compare>
+const typename PersistentAVLTree<Key, Value, Compare>::NodePtr&
+PersistentAVLTree<Key, Value, Compare>::getRoot() const {
+  return root;
+}
+
+template <typename Key, typename Value, typename Compare>
+typename PersistentAVLTree<Key, Value, Compare>::key_compare
+PersistentAVLTree<Key, Value, Compare>::key_comp() const {
+  return compare;
+}
+
+template <typename Key, typename Value, typename Compare>
+PersistentAVLTree<Key, Value, Compare>
+PersistentAVLTree<Key, Value, Compare>::insert(
+    const Key& key, const mapped_type& obj) const {
+  bool changed = false;
+  NodePtr newRoot = setNode(root, key, obj, false, changed);
+  return changed ? withRoot(std::move(newRoot), count + 1) : *this;
+}
+
+template <typename Key, typename Value, typename Compare>
+PersistentAVLTree<Key, Value, Compare>
+PersistentAVLTree<Key, Value, Compare>::insert_or_assign(
+    const Key& key, const mapped_type& obj) const {
+  bool added = false;
+  NodePtr newRoot = setNode(root, key, obj, true, added);
+  return withRoot(std::move(newRoot), added ? count + 1 : count);
+}
+
+template <typename Key, typename Value, typename Compare>
+PersistentAVLTree<Key, Value, Compare>
+PersistentAVLTree<Key, Value, Compare>::erase(const Key& key) const {
+  if (!contains(key)) {
+    return *this;
+  }
+  return withRoot(deleteNode(root, key), count - 1);
+}
+
+template <typename Key, typename Value, typename Compare>
+typename PersistentAVLTree<Key, Value, Compare>::NodePtr
+PersistentAVLTree<Key, Value, Compare>::makeNode(const value_type& value,
+                                                 NodePtr left, NodePtr right) {
+  return std::make_shared<Node>(value, std::move(left), std::move(right));
+}
+
+// Builds a node over subtrees whose heights differ by at most two; the
+// rotations create new nodes instead of changing the shared ones
+template <typename Key, typename Value, typename Compare>
+typename PersistentAVLTree<Key, Value, Compare>::NodePtr
+PersistentAVLTree<Key, Value, Compare>::balance(const value_type& value,
+                                                NodePtr left, NodePtr right) {
+  int leftHeight = getHeight(left);
+  int rightHeight = getHeight(right);
+  if (leftHeight > rightHeight + 1) {
+    if (getHeight(left->left) >= getHeight(left->right)) {
+      return makeNode(left->value, left->left,
+                      makeNode(value, left->right, std::move(right)));
+    }
+    const Node* pivot = left->right.get();
+    return makeNode(pivot->value,
+                    makeNode(left->value, left->left, pivot->left),
+                    makeNode(value, pivot->right, std::move(right)));
+  }
+  if (rightHeight > leftHeight + 1) {
+    if (getHeight(right->right) >= getHeight(right->left)) {
+      return makeNode(right->value,
+                      makeNode(value, std::move(left), right->left),
+                      right->right);
+    }
+    const Node* pivot = right->left.get();
+    return makeNode(pivot->value,
+                    makeNode(value, std::move(left), pivot->left),
+                    makeNode(right->value, pivot->right, right->right));
+  }
+  return makeNode(value, std::move(left), std::move(right));
+}
+
+template <typename Key, typename Value, typename Compare>
+int PersistentAVLTree<Key, Value, Compare>::getHeight(const NodePtr& node) {
+  return node == nullptr ? 0 : node->height;
+}
+
+template <typename Key, typename Value, typename Compare>
+const typename PersistentAVLTree<Key, Value, Compare>::Node*
+PersistentAVLTree<Key, Value, Compare>::findMin(const Node* node) {
+  while (node->left != nullptr) {
+    node = node->left.get();
+  }
+  return node;
+}
+
+template <typename Key, typename Value, typename Compare>
+typename PersistentAVLTree<Key, Value, Compare>::NodePtr
+PersistentAVLTree<Key, Value, Compare>::removeMin(const NodePtr& node) {
+  if (node->left == nullptr) {
+    return node->right;
+  }
+  return balance(node->value, removeMin(node->left), node->right);
+}
+
+// Copies the search path. `changed` reports whether a node was added; an
+// existing key is left alone unless `assign` is set, in which case only
+// its node is replaced and the heights above do not change
+template <typename Key, typename Value, typename Compare>
+typename PersistentAVLTree<Key, Value, Compare>::NodePtr
+PersistentAVLTree<Key, Value, Compare>::setNode(const NodePtr& node,
+                                                const Key& key,
+                                                const mapped_type& obj,
+                                                bool assign,
+                                                bool& changed) const {
+  if (node == nullptr) {
+    changed = true;
+    return makeNode(value_type(key, obj), nullptr, nullptr);
+  }
+  if (compare(key, node->value.first)) {
+    NodePtr left = setNode(node->left, key, obj, assign, changed);
+    if (left == node->left) {
+      return node;
+    }
+    return balance(node->value, std::move(left), node->right);
+  }
+  if (compare(node->value.first, key)) {
+    NodePtr right = setNode(node->right, key, obj, assign, changed);
+    if (right == node->right) {
+      return node;
+    }
+    return balance(node->value, node->left, std::move(right));
+  }
+  if (!assign) {
+    return node;
+  }
+  return makeNode(value_type(node->value.first, obj), node->left,
+                  node->right);
+}
+
+// The key is known to be present
+template <typename Key, typename Value, typename Compare>
+typename PersistentAVLTree<Key, Value, Compare>::NodePtr
+PersistentAVLTree<Key, Value, Compare>::deleteNode(const NodePtr& node,
+                                                   const Key& key) const {
+  if (compare(key, node->value.first)) {
+    return balance(node->value, deleteNode(node->left, key), node->right);
+  }
+  if (compare(node->value.first, key)) {
+    return balance(node->value, node->left, deleteNode(node->right, key));
+  }
+  if (node->left == nullptr) {
+    return node->right;
+  }
+  if (node->right == nullptr) {
+    return node->left;
+  }
+  return balance(findMin(node->right.get())->value, node->left,
+                 removeMin(node->right));
+}
+
+template <typename Key, typename Value, typename Compare>
+PersistentAVLTree<Key, Value, Compare>
+PersistentAVLTree<Key, Value, Compare>::withRoot(NodePtr newRoot,
+                                                 size_type newSize) const {
+  PersistentAVLTree result(compare);
+  result.root = std::move(newRoot);
+  result.count = newSize;
+  return result;
+}
+
+}  // namespace s21
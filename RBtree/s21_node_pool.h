@@ -0,0 +1,131 @@
+#ifndef S21_NODE_POOL_H
+#define S21_NODE_POOL_H
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+namespace s21 {
+
+// Пул узлов фиксированного размера. Память запрашивается у системы слэбами
+// (блоками на много узлов, размер блока растёт геометрически), освобождённые
+// узлы попадают в free-list и переиспользуются без обращения к new/delete.
+// Пул не потокобезопасен: разделять его можно только между деревьями,
+// которые используются из одного потока.
+template <typename T>
+class NodePool {
+ public:
+  static constexpr size_t kFirstSlabNodes = 32;
+  static constexpr size_t kMaxSlabNodes = 65536;
+
+  NodePool() = default;
+  NodePool(const NodePool&) = delete;
+  NodePool& operator=(const NodePool&) = delete;
+
+  ~NodePool() { release(); }
+
+  // Возвращает неинициализированную память под один T
+  T* allocate() {
+    Slot* slot = free_list_;
+    if (slot) {
+      free_list_ = slot->next;
+      if (!free_list_) {
+        free_tail_ = nullptr;
+      }
+    } else {
+      if (bump_ == bump_end_) {
+        grow();
+      }
+      slot = bump_++;
+    }
+    ++in_use_;
+    return reinterpret_cast<T*>(slot);
+  }
+
+  // Объект должен быть уже разрушен вызывающим кодом
+  void deallocate(T* ptr) noexcept {
+    Slot* slot = reinterpret_cast<Slot*>(ptr);
+    slot->next = free_list_;
+    if (!free_list_) {
+      free_tail_ = slot;
+    }
+    free_list_ = slot;
+    --in_use_;
+  }
+
+  // Забирает себе все слэбы other вместе с выделенными из них объектами:
+  // после этого объекты можно освобождать через этот пул. Свободные узлы
+  // other переходят в наш free-list, нетронутый хвост его последнего слэба
+  // больше не используется. Работает за O(число слэбов).
+  void adopt(NodePool& other) {
+    if (&other == this) {
+      return;
+    }
+    slabs_.insert(slabs_.end(), other.slabs_.begin(), other.slabs_.end());
+    if (other.free_list_) {
+      other.free_tail_->next = free_list_;
+      if (!free_list_) {
+        free_tail_ = other.free_tail_;
+      }
+      free_list_ = other.free_list_;
+    }
+    capacity_ += other.capacity_;
+    in_use_ += other.in_use_;
+    other.slabs_.clear();
+    other.free_list_ = other.free_tail_ = nullptr;
+    other.bump_ = other.bump_end_ = nullptr;
+    other.next_slab_nodes_ = kFirstSlabNodes;
+    other.capacity_ = 0;
+    other.in_use_ = 0;
+  }
+
+  // Отдаёт все слэбы системе. Все выделенные объекты к этому моменту
+  // должны быть разрушены (или быть тривиально разрушаемыми).
+  void release() noexcept {
+    for (Slot* slab : slabs_) {
+      ::operator delete(slab, std::align_val_t(alignof(Slot)));
+    }
+    slabs_.clear();
+    free_list_ = free_tail_ = nullptr;
+    bump_ = bump_end_ = nullptr;
+    next_slab_nodes_ = kFirstSlabNodes;
+    capacity_ = 0;
+    in_use_ = 0;
+  }
+
+  size_t in_use() const { return in_use_; }
+
+  size_t capacity() const { return capacity_; }
+
+ private:
+  union Slot {
+    Slot* next;
+    alignas(T) unsigned char storage[sizeof(T)];
+  };
+
+  void grow() {
+    slabs_.reserve(slabs_.size() + 1);
+    Slot* slab = static_cast<Slot*>(::operator new(
+        next_slab_nodes_ * sizeof(Slot), std::align_val_t(alignof(Slot))));
+    slabs_.push_back(slab);
+    bump_ = slab;
+    bump_end_ = slab + next_slab_nodes_;
+    capacity_ += next_slab_nodes_;
+    if (next_slab_nodes_ < kMaxSlabNodes) {
+      next_slab_nodes_ *= 2;
+    }
+  }
+
+  Slot* free_list_ = nullptr;
+  Slot* free_tail_ = nullptr;
+  Slot* bump_ = nullptr;
+  Slot* bump_end_ = nullptr;
+  std::vector<Slot*> slabs_;
+  size_t next_slab_nodes_ = kFirstSlabNodes;
+  size_t capacity_ = 0;
+  size_t in_use_ = 0;
+};
+
+}  // namespace s21
+
+#endif  // S21_NODE_POOL_H
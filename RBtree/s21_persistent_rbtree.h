@@ -0,0 +1,385 @@
+#ifndef S21_PERSISTENT_RBTREE_H
+#define S21_PERSISTENT_RBTREE_H
+
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "s21_rbtree.h"
+
+namespace s21 {
+
+// Неизменяемое (персистентное) красно-чёрное дерево. insert и erase не
+// меняют дерево, а возвращают новую версию: копируются только узлы на
+// пути от корня к изменённому месту (O(log n) новых узлов), всё
+// остальное разделяется между версиями. Узлы живут в shared_ptr и
+// освобождаются, когда на них не ссылается ни одна версия, поэтому
+// копирование дерева (снимок) стоит O(1).
+//
+// Вставка — функциональная балансировка Окасаки, удаление — алгоритм
+// Карса (S. Kahrs, "Red-black trees with types", 2001). Родительских
+// указателей нет: узел может входить сразу в несколько версий, поэтому
+// итератор хранит путь от корня.
+template <typename Key, typename Compare = std::less<Key>>
+class PersistentRBTree {
+ public:
+  struct Node;
+  using NodePtr = std::shared_ptr<const Node>;
+
+  struct Node {
+    Key data;
+    Color color;
+    NodePtr left;
+    NodePtr right;
+
+    template <typename K>
+    Node(Color c, NodePtr l, K&& key, NodePtr r)
+        : data(std::forward<K>(key)),
+          color(c),
+          left(std::move(l)),
+          right(std::move(r)) {}
+  };
+
+  // Итератор только вперёд: стек содержит текущий узел и предков, от
+  // которых спуск шёл влево, то есть ещё не пройденные узлы. Действителен,
+  // пока жива любая версия, содержащая эти узлы.
+  class const_iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Key;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const Key*;
+    using reference = const Key&;
+
+    const_iterator() = default;
+
+    reference operator*() const { return path_.back()->data; }
+    pointer operator->() const { return &path_.back()->data; }
+
+    const_iterator& operator++() {
+      const Node* node = path_.back();
+      path_.pop_back();
+      pushLeft(node->right.get());
+      return *this;
+    }
+
+    const_iterator operator++(int) {
+      const_iterator old = *this;
+      ++*this;
+      return old;
+    }
+
+    bool operator==(const const_iterator& other) const {
+      return current() == other.current();
+    }
+
+    bool operator!=(const const_iterator& other) const {
+      return current() != other.current();
+    }
+
+   private:
+    friend class PersistentRBTree;
+
+    const Node* current() const {
+      return path_.empty() ? nullptr : path_.back();
+    }
+
+    void pushLeft(const Node* node) {
+      for (; node; node = node->left.get()) {
+        path_.push_back(node);
+      }
+    }
+
+    std::vector<const Node*> path_;
+  };
+
+  using iterator = const_iterator;
+
+  PersistentRBTree() = default;
+  explicit PersistentRBTree(const Compare& comp) : comp_(comp) {}
+
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  const NodePtr& root() const { return root_; }
+
+  const_iterator begin() const {
+    const_iterator it;
+    it.pushLeft(root_.get());
+    return it;
+  }
+
+  const_iterator end() const { return const_iterator(); }
+
+  const Compare& key_comp() const { return comp_; }
+
+  // Итератор на key или end(). Путь собирается во время того же спуска:
+  // в стек попадают узлы, от которых спуск шёл влево, и найденный узел
+  const_iterator find(const Key& key) const {
+    const_iterator it;
+    for (const Node* node = root_.get(); node;) {
+      if (comp_(key, node->data)) {
+        it.path_.push_back(node);
+        node = node->left.get();
+      } else if (comp_(node->data, key)) {
+        node = node->right.get();
+      } else {
+        it.path_.push_back(node);
+        return it;
+      }
+    }
+    return end();
+  }
+
+  bool contains(const Key& key) const { return findNode(key) != nullptr; }
+
+  // Первый элемент не меньше key
+  const_iterator lower_bound(const Key& key) const {
+    const_iterator it;
+    for (const Node* node = root_.get(); node;) {
+      if (comp_(node->data, key)) {
+        node = node->right.get();
+      } else {
+        it.path_.push_back(node);
+        node = node->left.get();
+      }
+    }
+    return it;
+  }
+
+  // Новая версия с key; если ключ уже есть, возвращается та же версия
+  PersistentRBTree insert(const Key& key) const { return insertKey(key); }
+  PersistentRBTree insert(Key&& key) const {
+    return insertKey(std::move(key));
+  }
+
+  // Новая версия без key. Алгоритм Карса рассчитан на удаление
+  // присутствующего ключа, поэтому отсутствующий проверяется заранее
+  PersistentRBTree erase(const Key& key) const {
+    if (!contains(key)) {
+      return *this;
+    }
+    PersistentRBTree result(comp_);
+    result.root_ = blacken(remove(root_, key));
+    result.size_ = size_ - 1;
+    return result;
+  }
+
+  // Один и тот же корень означает одну и ту же версию
+  bool sameVersion(const PersistentRBTree& other) const {
+    return root_ == other.root_;
+  }
+
+ private:
+  static constexpr Color kRed = Color::RED;
+  static constexpr Color kBlack = Color::BLACK;
+
+  const Node* findNode(const Key& key) const {
+    const Node* node = root_.get();
+    while (node) {
+      if (comp_(key, node->data)) {
+        node = node->left.get();
+      } else if (comp_(node->data, key)) {
+        node = node->right.get();
+      } else {
+        return node;
+      }
+    }
+    return nullptr;
+  }
+
+  template <typename K>
+  PersistentRBTree insertKey(K&& key) const {
+    bool inserted = false;
+    NodePtr root = place(root_, std::forward<K>(key), inserted);
+    if (!inserted) {
+      return *this;
+    }
+    PersistentRBTree result(comp_);
+    result.root_ = blacken(root);
+    result.size_ = size_ + 1;
+    return result;
+  }
+
+  template <typename K>
+  static NodePtr make(Color color, NodePtr left, K&& key, NodePtr right) {
+    return std::make_shared<Node>(color, std::move(left),
+                                  std::forward<K>(key), std::move(right));
+  }
+
+  static bool isRed(const NodePtr& node) {
+    return node && node->color == kRed;
+  }
+
+  // Непустой чёрный узел
+  static bool isBlack(const NodePtr& node) {
+    return node && node->color == kBlack;
+  }
+
+  static NodePtr blacken(const NodePtr& node) {
+    return isRed(node) ? make(kBlack, node->left, node->data, node->right)
+                       : node;
+  }
+
+  static NodePtr redden(const NodePtr& node) {
+    return make(kRed, node->left, node->data, node->right);
+  }
+
+  // Спуск с копированием пути. Если ключ уже есть, поддерево
+  // возвращается как есть и выше ничего не копируется
+  template <typename K>
+  NodePtr place(const NodePtr& node, K&& key, bool& inserted) const {
+    if (!node) {
+      inserted = true;
+      return make(kRed, nullptr, std::forward<K>(key), nullptr);
+    }
+    if (comp_(key, node->data)) {
+      NodePtr left = place(node->left, std::forward<K>(key), inserted);
+      if (!inserted) {
+        return node;
+      }
+      return node->color == kBlack
+                 ? balance(left, node->data, node->right)
+                 : make(kRed, std::move(left), node->data, node->right);
+    }
+    if (comp_(node->data, key)) {
+      NodePtr right = place(node->right, std::forward<K>(key), inserted);
+      if (!inserted) {
+        return node;
+      }
+      return node->color == kBlack
+                 ? balance(node->left, node->data, right)
+                 : make(kRed, node->left, node->data, std::move(right));
+    }
+    return node;
+  }
+
+  // Чёрный узел left-key-right, у которого один из потомков может быть
+  // красным с красным ребёнком. Первый случай (оба потомка красные) нужен
+  // удалению: перекраска вместо поворота
+  static NodePtr balance(const NodePtr& left, const Key& key,
+                         const NodePtr& right) {
+    if (isRed(left) && isRed(right)) {
+      return make(kRed, blacken(left), key, blacken(right));
+    }
+    if (isRed(left)) {
+      if (isRed(left->left)) {
+        return make(kRed, blacken(left->left), left->data,
+                    make(kBlack, left->right, key, right));
+      }
+      if (isRed(left->right)) {
+        return make(kRed,
+                    make(kBlack, left->left, left->data, left->right->left),
+                    left->right->data,
+                    make(kBlack, left->right->right, key, right));
+      }
+    }
+    if (isRed(right)) {
+      if (isRed(right->right)) {
+        return make(kRed, make(kBlack, left, key, right->left), right->data,
+                    blacken(right->right));
+      }
+      if (isRed(right->left)) {
+        return make(kRed, make(kBlack, left, key, right->left->left),
+                    right->left->data,
+                    make(kBlack, right->left->right, right->data,
+                         right->right));
+      }
+    }
+    return make(kBlack, left, key, right);
+  }
+
+  // Удаление присутствующего ключа. Если спуск идёт в чёрного потомка,
+  // чёрная высота этого поддерева уменьшается на единицу, и
+  // balanceLeft/balanceRight восстанавливают её
+  NodePtr remove(const NodePtr& node, const Key& key) const {
+    if (comp_(key, node->data)) {
+      NodePtr left = remove(node->left, key);
+      return isBlack(node->left)
+                 ? balanceLeft(left, node->data, node->right)
+                 : make(kRed, std::move(left), node->data, node->right);
+    }
+    if (comp_(node->data, key)) {
+      NodePtr right = remove(node->right, key);
+      return isBlack(node->right)
+                 ? balanceRight(node->left, node->data, right)
+                 : make(kRed, node->left, node->data, std::move(right));
+    }
+    return join(node->left, node->right);
+  }
+
+  // Левое поддерево на единицу ниже по чёрной высоте, чем правое
+  static NodePtr balanceLeft(const NodePtr& left, const Key& key,
+                             const NodePtr& right) {
+    if (isRed(left)) {
+      return make(kRed, blacken(left), key, right);
+    }
+    if (isBlack(right)) {
+      return balance(left, key, redden(right));
+    }
+    // right красный, и его левый потомок обязательно чёрный
+    return make(kRed, make(kBlack, left, key, right->left->left),
+                right->left->data,
+                balance(right->left->right, right->data,
+                        redden(right->right)));
+  }
+
+  static NodePtr balanceRight(const NodePtr& left, const Key& key,
+                              const NodePtr& right) {
+    if (isRed(right)) {
+      return make(kRed, left, key, blacken(right));
+    }
+    if (isBlack(left)) {
+      return balance(redden(left), key, right);
+    }
+    return make(kRed,
+                balance(redden(left->left), left->data, left->right->left),
+                left->right->data,
+                make(kBlack, left->right->right, key, right));
+  }
+
+  // Склеивает поддеревья удалённого узла: все ключи left меньше ключей
+  // right, чёрные высоты равны
+  static NodePtr join(const NodePtr& left, const NodePtr& right) {
+    if (!left) {
+      return right;
+    }
+    if (!right) {
+      return left;
+    }
+    if (isRed(left) && isRed(right)) {
+      NodePtr middle = join(left->right, right->left);
+      if (isRed(middle)) {
+        return make(kRed, make(kRed, left->left, left->data, middle->left),
+                    middle->data,
+                    make(kRed, middle->right, right->data, right->right));
+      }
+      return make(kRed, left->left, left->data,
+                  make(kRed, middle, right->data, right->right));
+    }
+    if (isBlack(left) && isBlack(right)) {
+      NodePtr middle = join(left->right, right->left);
+      if (isRed(middle)) {
+        return make(kRed, make(kBlack, left->left, left->data, middle->left),
+                    middle->data,
+                    make(kBlack, middle->right, right->data, right->right));
+      }
+      return balanceLeft(left->left, left->data,
+                         make(kBlack, middle, right->data, right->right));
+    }
+    if (isRed(right)) {
+      return make(kRed, join(left, right->left), right->data, right->right);
+    }
+    return make(kRed, left->left, left->data, join(left->right, right));
+  }
+
+  NodePtr root_;
+  size_t size_ = 0;
+  Compare comp_;
+};
+
+}  // namespace s21
+
+#endif  // S21_PERSISTENT_RBTREE_H
@@ -2,35 +2,186 @@
 #define S21_RBTREE_H
 
 #include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <iterator>
 #include <iostream>
 #include <limits>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "s21_node_pool.h"
 
 namespace s21 {
 
 enum class Color { RED, BLACK };
 
-template <typename Key, bool AllowDuplicates = false>
+// Размер поддерева хранится в узле только в режиме порядковой статистики
+template <bool Enabled>
+struct RBNodeSize {
+  size_t subtree_size = 1;
+};
+
+template <>
+struct RBNodeSize<false> {};
+
+// Узел с цветом в отдельном поле. Ключ идёт первым, за ним указатели,
+// которые читаются при спуске по дереву.
+template <typename Key, bool Compact, bool OrderStatistic>
+struct RBNode : RBNodeSize<OrderStatistic> {
+  Key data;
+  Color color;
+  RBNode* parent;
+  RBNode* left;
+  RBNode* right;
+
+  RBNode(Key value) : RBNode(std::in_place, std::move(value)) {}
+
+  // Ключ конструируется из args на месте, без промежуточной копии
+  template <typename... Args>
+  explicit RBNode(std::in_place_t, Args&&... args)
+      : data(std::forward<Args>(args)...),
+        color(Color::RED),
+        parent(nullptr),
+        left(nullptr),
+        right(nullptr) {}
+
+  RBNode* getParent() const { return parent; }
+  void setParent(RBNode* node) { parent = node; }
+  Color getColor() const { return color; }
+  void setColor(Color value) { color = value; }
+};
+
+// Компактный узел: цвет хранится в младшем бите указателя на родителя,
+// который всегда равен нулю из-за выравнивания узла. Для ключей размером
+// в слово это экономит 8 байт на узел (40 -> 32 для uint64_t), для
+// 4-байтовых ключей цвет и так помещается в выравнивание за ключом.
+template <typename Key, bool OrderStatistic>
+struct RBNode<Key, true, OrderStatistic> : RBNodeSize<OrderStatistic> {
+  Key data;
+  RBNode* left;
+  RBNode* right;
+
+  RBNode(Key value) : RBNode(std::in_place, std::move(value)) {}
+
+  template <typename... Args>
+  explicit RBNode(std::in_place_t, Args&&... args)
+      : data(std::forward<Args>(args)...),
+        left(nullptr),
+        right(nullptr),
+        parent_color_(0) {}
+
+  RBNode* getParent() const {
+    return reinterpret_cast<RBNode*>(parent_color_ & ~kColorBit);
+  }
+  void setParent(RBNode* node) {
+    parent_color_ = reinterpret_cast<uintptr_t>(node) |
+                    (parent_color_ & kColorBit);
+  }
+  // Нулевой бит означает красный цвет, как у только что созданного узла
+  Color getColor() const {
+    return (parent_color_ & kColorBit) ? Color::BLACK : Color::RED;
+  }
+  void setColor(Color value) {
+    parent_color_ = (parent_color_ & ~kColorBit) |
+                    (value == Color::BLACK ? kColorBit : 0);
+  }
+
+ private:
+  static constexpr uintptr_t kColorBit = 1;
+  static_assert(alignof(RBNode*) > 1, "color bit needs aligned pointers");
+
+  uintptr_t parent_color_;
+};
+
+// OrderStatistic включает хранение размеров поддеревьев, что даёт
+// select/rank/count_range за O(log n) ценой одного size_t на узел.
+// CompactNodes выбирает узел с цветом в бите указателя на родителя.
+template <typename Key, bool AllowDuplicates = false,
+          typename Compare = std::less<Key>, bool OrderStatistic = false,
+          bool CompactNodes = false>
 class RBTree {
  public:
-  struct Node {
-    Key data;
-    Color color;
-    Node* parent;
-    Node* left;
-    Node* right;
-
-    Node(Key value)
-        : data(value),
-          color(Color::RED),
-          parent(nullptr),
-          left(nullptr),
-          right(nullptr) {}
+  using Node = RBNode<Key, CompactNodes, OrderStatistic>;
+
+  using node_pool = NodePool<Node>;
+
+  // Узел, извлечённый из дерева: владеет им вместе с ключом, пока узел не
+  // будет вставлен в другое дерево. Держит пул, из которого взят узел,
+  // чтобы освободить его, если до вставки дело не дойдёт.
+  class node_handle {
+   public:
+    node_handle() = default;
+
+    node_handle(node_handle&& other) noexcept
+        : node_(other.node_), pool_(std::move(other.pool_)) {
+      other.node_ = nullptr;
+    }
+
+    node_handle& operator=(node_handle&& other) noexcept {
+      if (this != &other) {
+        reset();
+        node_ = other.node_;
+        pool_ = std::move(other.pool_);
+        other.node_ = nullptr;
+      }
+      return *this;
+    }
+
+    ~node_handle() { reset(); }
+
+    bool empty() const { return node_ == nullptr; }
+    explicit operator bool() const { return node_ != nullptr; }
+
+    // Ключ можно менять: узел уже не в дереве
+    Key& value() const { return node_->data; }
+
+   private:
+    friend class RBTree;
+
+    node_handle(Node* node, std::shared_ptr<node_pool> pool)
+        : node_(node), pool_(std::move(pool)) {}
+
+    void reset() {
+      if (node_) {
+        node_->~Node();
+        pool_->deallocate(node_);
+        node_ = nullptr;
+      }
+    }
+
+    Node* node_ = nullptr;
+    std::shared_ptr<node_pool> pool_;
   };
 
   RBTree() : root_(nullptr), size_(0) {}
 
-  RBTree(RBTree&& other) : root_(other.root_), size_(other.size_) {
+  explicit RBTree(const Compare& comp)
+      : root_(nullptr), size_(0), comp_(comp) {}
+
+  // Дерево, берущее узлы из общего с другими деревьями пула
+  explicit RBTree(std::shared_ptr<node_pool> pool,
+                  const Compare& comp = Compare())
+      : root_(nullptr), size_(0), pool_(std::move(pool)), comp_(comp) {}
+
+  // Копия получает собственный пул узлов
+  RBTree(const RBTree& other) : root_(nullptr), size_(0), comp_(other.comp_) {
+    cloneFrom(other);
+  }
+
+  RBTree(RBTree&& other)
+      : root_(other.root_),
+        leftmost_(other.leftmost_),
+        rightmost_(other.rightmost_),
+        size_(other.size_),
+        pool_(std::move(other.pool_)),
+        comp_(std::move(other.comp_)) {
     other.root_ = nullptr;
+    other.leftmost_ = other.rightmost_ = nullptr;
     other.size_ = 0;
   }
 
@@ -38,38 +189,171 @@ class RBTree {
     if (this != &other) {
       clear();
       root_ = other.root_;
+      leftmost_ = other.leftmost_;
+      rightmost_ = other.rightmost_;
       size_ = other.size_;
+      pool_ = std::move(other.pool_);
+      comp_ = std::move(other.comp_);
       other.root_ = nullptr;
+      other.leftmost_ = other.rightmost_ = nullptr;
       other.size_ = 0;
     }
     return *this;
   }
 
+  RBTree& operator=(const RBTree& other) {
+    if (this != &other) {
+      comp_ = other.comp_;
+      cloneFrom(other);
+    }
+    return *this;
+  }
+
   bool empty() const { return root_ == nullptr; }
 
   ~RBTree() { clear(); }
 
   Node* getRoot() const { return root_; }
 
-  void insert(const Key& value) {
-    if constexpr (!AllowDuplicates) {
-      if (contains(value)) return;  // Запрещаем дубликаты для set
-    }
-    Node* new_node = new Node(value);
-    if (!root_) {
-      root_ = new_node;
-    } else {
-      insertRec(root_, new_node);
+  Compare key_comp() const { return comp_; }
+
+  // Пул создаётся лениво, при первой вставке
+  const std::shared_ptr<node_pool>& pool() {
+    if (!pool_) {
+      pool_ = std::make_shared<node_pool>();
     }
-    fixInsert(new_node);
-    size_++;
+    return pool_;
+  }
+
+  // Вставка за один итеративный спуск. Возвращает вставленный узел либо,
+  // если дубликаты запрещены, уже имеющийся узел с равным ключом. Ключ
+  // больше текущего максимума (возрастающий поток) подвешивается к
+  // rightmost_ без спуска. Узел создаётся только после поиска места, так
+  // что при отказе rvalue-ключ не перемещается.
+  std::pair<Node*, bool> insert(const Key& value) {
+    return placeNode(findPosition(value), value);
+  }
+
+  std::pair<Node*, bool> insert(Key&& value) {
+    return placeNode(findPosition(value), std::move(value));
+  }
+
+  // Вставка с подсказкой, как у std::set: value ставится рядом с hint
+  // (nullptr — конец дерева), сначала перед ним, а если value больше hint —
+  // сразу после. Если порядок это допускает, узел подвешивается к соседу
+  // без спуска от корня, и вставка вместе с перебалансировкой стоит
+  // амортизированно O(1). Иначе подсказка игнорируется.
+  std::pair<Node*, bool> insertHint(Node* hint, const Key& value) {
+    return placeNode(hintPosition(hint, value), value);
+  }
+
+  std::pair<Node*, bool> insertHint(Node* hint, Key&& value) {
+    return placeNode(hintPosition(hint, value), std::move(value));
+  }
+
+  // Ключ конструируется из args прямо в узле. Место ищется по уже
+  // построенному ключу, поэтому для set при совпадении узел уничтожается.
+  template <typename... Args>
+  std::pair<Node*, bool> emplace(Args&&... args) {
+    Node* node = createNode(std::forward<Args>(args)...);
+    return linkOrDestroy(findPosition(node->data), node);
+  }
+
+  template <typename... Args>
+  std::pair<Node*, bool> emplaceHint(Node* hint, Args&&... args) {
+    Node* node = createNode(std::forward<Args>(args)...);
+    return linkOrDestroy(hintPosition(hint, node->data), node);
+  }
+
+  // Поиск делает одно сравнение на уровень: спуск как в lower_bound и
+  // проверка равенства в конце. В мультисете находится первый из равных.
+  // Для скалярных ключей множества спуск останавливается на равном узле.
+  Node* find(const Key& value) { return findNode(value); }
+
+  const Node* find(const Key& value) const { return findNode(value); }
+
+  // Гетерогенный поиск для прозрачных компараторов (std::less<> и т.п.)
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  Node* find(const K& key) {
+    return findNode(key);
+  }
+
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  const Node* find(const K& key) const {
+    return findNode(key);
   }
 
-  Node* find(const Key& value) { return findRec(root_, value); }
+  bool contains(const Key& value) const { return findNode(value) != nullptr; }
 
-  const Node* find(const Key& value) const { return findRec(root_, value); }
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  bool contains(const K& key) const {
+    return findNode(key) != nullptr;
+  }
+
+  // Первый узел с ключом не меньше заданного
+  Node* lower_bound(const Key& value) const { return lowerBoundNode(value); }
+
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  Node* lower_bound(const K& key) const {
+    return lowerBoundNode(key);
+  }
+
+  // Первый узел с ключом строго больше заданного
+  Node* upper_bound(const Key& value) const { return upperBoundNode(value); }
+
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  Node* upper_bound(const K& key) const {
+    return upperBoundNode(key);
+  }
+
+  // Полуинтервал [first, second) узлов с ключом, равным заданному
+  std::pair<Node*, Node*> equal_range(const Key& value) const {
+    return equalRangeNodes(value);
+  }
+
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  std::pair<Node*, Node*> equal_range(const K& key) const {
+    return equalRangeNodes(key);
+  }
+
+  // k-й по порядку узел (нумерация с нуля) или nullptr, если k >= size()
+  Node* select(size_t k) const {
+    static_assert(OrderStatistic, "select requires OrderStatistic RBTree");
+    Node* current = root_;
+    while (current) {
+      size_t left_size = subtreeSize(current->left);
+      if (k < left_size) {
+        current = current->left;
+      } else if (k == left_size) {
+        return current;
+      } else {
+        k -= left_size + 1;
+        current = current->right;
+      }
+    }
+    return nullptr;
+  }
+
+  // Количество ключей, строго меньших заданного
+  size_t rank(const Key& value) const {
+    static_assert(OrderStatistic, "rank requires OrderStatistic RBTree");
+    return countLess(value);
+  }
 
-  bool contains(const Key& value) const { return find(value) != nullptr; }
+  // Количество ключей в отрезке [lo, hi]
+  size_t count_range(const Key& lo, const Key& hi) const {
+    static_assert(OrderStatistic, "count_range requires OrderStatistic RBTree");
+    if (comp_(hi, lo)) {
+      return 0;
+    }
+    return countNotGreater(hi) - countLess(lo);
+  }
 
   size_t size() const { return size_; }
 
@@ -77,12 +361,300 @@ class RBTree {
     return std::numeric_limits<size_t>::max() / (sizeof(Node) + sizeof(*this));
   }
 
+  // Если пул только наш, после очистки его слэбы возвращаются системе, так
+  // что пиковая память не удерживается. Ключам без деструкторов обход
+  // дерева при этом не нужен.
   void clear() {
-    clear(root_);
+    bool own_pool = pool_ && pool_.use_count() == 1;
+    if (!own_pool || !std::is_trivially_destructible_v<Key>) {
+      clear(root_);
+    }
+    if (own_pool) {
+      pool_->release();
+    }
     root_ = nullptr;
+    leftmost_ = rightmost_ = nullptr;
     size_ = 0;
   }
 
+  // Заменяет содержимое деревом, построенным снизу вверх за O(n) из count
+  // элементов, идущих по возрастанию (для set строго по возрастанию).
+  // Дерево получается идеально сбалансированным: все узлы черные, кроме
+  // узлов последнего уровня, которые окрашиваются в красный.
+  template <typename InputIt>
+  void buildFromSorted(InputIt first, size_t count) {
+    clear();
+    auto next = [this, &first]() {
+      Node* node = createNode(*first);
+      ++first;
+      return node;
+    };
+    buildRoot(next, count);
+  }
+
+  // Теоретико-множественные операции: результат заменяет содержимое *this.
+  // Для мультимножеств учитываются кратности, как в std::set_union и др.
+  // При сравнимых размерах выполняется слияние обходов с перестройкой
+  // дерева за O(n + m), при маленьком other — поэлементные вставки и
+  // удаления за O(m log n).
+  void unionWith(const RBTree& other) {
+    if (!AllowDuplicates && isLopsided(other)) {
+      for (const Node* node = minimum(other.root_); node;
+           node = successor(node)) {
+        insert(node->data);
+      }
+    } else {
+      mergeWith(other, true, true, true);
+    }
+  }
+
+  void intersectWith(const RBTree& other) {
+    mergeWith(other, false, true, false);
+  }
+
+  void differenceWith(const RBTree& other) {
+    if (isLopsided(other)) {
+      for (const Node* node = minimum(other.root_); node;
+           node = successor(node)) {
+        erase(node->data);
+      }
+    } else {
+      mergeWith(other, true, false, false);
+    }
+  }
+
+  void symmetricDifferenceWith(const RBTree& other) {
+    if (!AllowDuplicates && isLopsided(other)) {
+      for (const Node* node = minimum(other.root_); node;
+           node = successor(node)) {
+        Node* found = findNode(node->data);
+        if (found) {
+          eraseNode(found);
+          size_--;
+        } else {
+          insert(node->data);
+        }
+      }
+    } else {
+      mergeWith(other, true, false, true);
+    }
+  }
+
+  // Заменяет содержимое копией other той же формы и раскраски
+  void cloneFrom(const RBTree& other) {
+    if (this == &other) {
+      return;
+    }
+    clear();
+    if (!other.root_) {
+      return;
+    }
+    root_ = copyShape<false>(other.root_);
+    leftmost_ = minimum(root_);
+    rightmost_ = maximum(root_);
+    size_ = other.size_;
+  }
+
+  // Отделяет от дерева все ключи, не меньшие key, и возвращает их отдельным
+  // деревом. Разрез делается за O(log n) через последовательность join по
+  // пути поиска. Пул не потокобезопасен, а части обычно расходятся по
+  // разным потокам, поэтому меньшая часть переносится в собственный пул;
+  // в обычном дереве она же и пересчитывается. Итого
+  // O(log n + min(|left|, |right|)).
+  RBTree split(const Key& key) {
+    RBTree right_tree(comp_);
+    if (!root_) {
+      return right_tree;
+    }
+    struct Step {
+      Node* node;
+      size_t child_height;
+      bool to_left;
+    };
+    // Высота красно-черного дерева не больше 2 * log2(n + 1)
+    Step path[2 * std::numeric_limits<size_t>::digits];
+    size_t depth = 0;
+    size_t height = blackHeight(root_);
+    for (Node* node = root_; node;) {
+      size_t child_height = height - (node->getColor() == Color::BLACK ? 1 : 0);
+      bool to_left = comp_(node->data, key);
+      path[depth++] = {node, child_height, to_left};
+      node = to_left ? node->right : node->left;
+      height = child_height;
+    }
+    // Собираем части снизу вверх: узел пути вместе со своим поддеревьем по
+    // другую сторону от разреза присоединяется к соответствующей части
+    Node* left = nullptr;
+    Node* right = nullptr;
+    size_t left_height = 0;
+    size_t right_height = 0;
+    while (depth > 0) {
+      Step step = path[--depth];
+      if (step.to_left) {
+        left_height = joinAt(step.node->left, step.child_height, step.node,
+                             left, left_height);
+        left = root_;
+      } else {
+        right_height = joinAt(right, right_height, step.node,
+                              step.node->right, step.child_height);
+        right = root_;
+      }
+    }
+    size_t total = size_;
+    root_ = left;
+    leftmost_ = minimum(left);
+    rightmost_ = maximum(left);
+    right_tree.root_ = right;
+    right_tree.leftmost_ = minimum(right);
+    right_tree.rightmost_ = maximum(right);
+    size_ = countNodes(left, right, total);
+    right_tree.size_ = total - size_;
+    right_tree.pool_ = pool_;
+    try {
+      if (right_tree.size_ <= size_) {
+        right_tree.moveToOwnPool();
+      } else {
+        moveToOwnPool();
+      }
+    } catch (...) {
+      // Части ещё в одном пуле, и обратный join не выделяет память
+      join(right_tree);
+      throw;
+    }
+    return right_tree;
+  }
+
+  // Присоединяет к дереву все элементы other, которые не меньше всех
+  // элементов *this (для set — строго больше), за O(log n + log m).
+  // other становится пустым. Если пул other разделён с деревьями, кроме
+  // *this, элементы копируются в наш пул по одному.
+  void join(RBTree& other) {
+    if (this == &other || !other.root_) {
+      return;
+    }
+    if (!root_) {
+      std::swap(root_, other.root_);
+      std::swap(leftmost_, other.leftmost_);
+      std::swap(rightmost_, other.rightmost_);
+      std::swap(size_, other.size_);
+      pool_.swap(other.pool_);
+      return;
+    }
+    Node* min = other.leftmost_;
+    if (AllowDuplicates ? comp_(min->data, rightmost_->data)
+                        : !comp_(rightmost_->data, min->data)) {
+      throw std::invalid_argument("join: key ranges of the trees overlap");
+    }
+    if (pool_ != other.pool_) {
+      if (other.pool_.use_count() == 1) {
+        pool_->adopt(*other.pool_);
+      } else {
+        for (const Node* node = min; node; node = successor(node)) {
+          insert(node->data);
+        }
+        other.clear();
+        return;
+      }
+    }
+    Node* max = other.rightmost_;
+    other.unlinkNode(min);
+    size_t total = size_ + other.size_;
+    size_t left_height = blackHeight(root_);
+    size_t right_height = blackHeight(other.root_);
+    joinAt(root_, left_height, min, other.root_, right_height);
+    rightmost_ = max;
+    size_ = total;
+    other.root_ = nullptr;
+    other.leftmost_ = other.rightmost_ = nullptr;
+    other.size_ = 0;
+  }
+
+  // Исключает узел из дерева без освобождения и передаёт его в handle
+  node_handle extract(Node* node) {
+    unlinkNode(node);
+    size_--;
+    return node_handle(node, pool_);
+  }
+
+  // Извлекает узел с ключом value (в мультисете первый из равных) или
+  // возвращает пустой handle
+  node_handle extract(const Key& value) {
+    Node* node = find(value);
+    return node ? extract(node) : node_handle();
+  }
+
+  // Подвешивает узел из handle без выделения памяти. Если в set уже есть
+  // равный ключ, handle сохраняет узел, а возвращается имеющийся узел.
+  // Узел перевешивается, только если он взят из пула этого дерева (в том
+  // числе явно разделённого конструктором с пулом). Иначе ключ
+  // перемещается в новый узел из своего пула, а узел возвращается в пул
+  // handle: пулы разных деревьев никогда не объединяются.
+  std::pair<Node*, bool> insert(node_handle&& handle) {
+    if (handle.empty()) {
+      return {nullptr, false};
+    }
+    Position pos = findPosition(handle.node_->data);
+    if (pos.equal) {
+      return {pos.equal, false};
+    }
+    if (!samePool(handle.pool_)) {
+      auto result = placeNode(pos, std::move(handle.node_->data));
+      handle.reset();
+      return result;
+    }
+    Node* node = handle.node_;
+    handle.node_ = nullptr;
+    resetLinks(node);
+    linkNode(pos.parent, pos.to_left, node);
+    return {node, true};
+  }
+
+  // Переносит из other узлы, ключей которых в дереве нет (в мультисет —
+  // все), перевешивая их, а не копируя. Равные ключи мультисета встают
+  // после имеющихся. Без выделения памяти узлы переходят, только если
+  // деревья явно созданы над общим пулом; иначе ключи перемещаются в
+  // новые узлы этого дерева, а узлы other освобождаются в его пул.
+  void merge(RBTree& other) {
+    if (this == &other || !other.root_) {
+      return;
+    }
+    bool relink = samePool(other.pool_);
+    for (Node* node = other.leftmost_; node;) {
+      Node* next = successor(node);
+      Position pos = findPosition(node->data);
+      if (!pos.equal) {
+        if (relink) {
+          other.unlinkNode(node);
+          other.size_--;
+          resetLinks(node);
+          linkNode(pos.parent, pos.to_left, node);
+        } else {
+          placeNode(pos, std::move(node->data));
+          other.eraseAt(node);
+        }
+      }
+      node = next;
+    }
+  }
+
+  // Вставка диапазона. В пустое дерево отсортированный диапазон прямого
+  // итератора строится за O(n), в остальных случаях элементы вставляются
+  // по одному.
+  template <typename InputIt>
+  void insertRange(InputIt first, InputIt last) {
+    using category = typename std::iterator_traits<InputIt>::iterator_category;
+    if constexpr (std::is_base_of_v<std::forward_iterator_tag, category>) {
+      if (empty() && isSortedRange(first, last)) {
+        buildFromSorted(first,
+                        static_cast<size_t>(std::distance(first, last)));
+        return;
+      }
+    }
+    for (; first != last; ++first) {
+      insert(*first);
+    }
+  }
+
   void erase(const Key& value) {
     Node* node = find(value);
     if (node) {
@@ -91,26 +663,63 @@ class RBTree {
     }
   }
 
-  size_t count(const Key& value) const {
-    size_t cnt = 0;
-    countRec(root_, value, cnt);
-    return cnt;
+  // Удаляет именно этот узел, без поиска по ключу, и возвращает следующий
+  // за ним. Остальные узлы при удалении не перемещаются, поэтому указатели
+  // на них остаются действительными.
+  Node* eraseAt(Node* node) {
+    Node* next = successor(node);
+    eraseNode(node);
+    size_--;
+    return next;
   }
 
-  void countRec(Node* node, const Key& value, size_t& cnt) const {
-    if (!node) return;
+  // Удаляет узлы [first, last) и возвращает last. Переход к следующему
+  // узлу амортизированно O(1), весь диапазон очищается без обхода по
+  // одному.
+  Node* eraseRange(Node* first, Node* last) {
+    if (first == leftmost_ && !last) {
+      clear();
+      return nullptr;
+    }
+    while (first != last) {
+      first = eraseAt(first);
+    }
+    return last;
+  }
 
-    if (value < node->data) {
-      countRec(node->left, value, cnt);
-    } else if (value > node->data) {
-      countRec(node->right, value, cnt);
-    } else {
-      cnt++;
-      countRec(node->left, value, cnt);
-      countRec(node->right, value, cnt);
+  size_t count(const Key& value) const { return countKeys(value); }
+
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  size_t count(const K& key) const {
+    return countKeys(key);
+  }
+
+  // Крайние узлы хранятся в дереве и обновляются при вставке и удалении,
+  // поэтому begin() и обход с конца начинаются без спуска. Для пустого
+  // дерева возвращается nullptr.
+  Node* first() const { return leftmost_; }
+
+  Node* last() const { return rightmost_; }
+
+  // Удаление минимума и максимума. У крайнего узла нет ребенка с внешней
+  // стороны, так что новый крайний узел находится за амортизированное O(1),
+  // как и перебалансировка после удаления. Пустое дерево не меняется.
+  void popFirst() {
+    if (leftmost_) {
+      eraseNode(leftmost_);
+      size_--;
+    }
+  }
+
+  void popLast() {
+    if (rightmost_) {
+      eraseNode(rightmost_);
+      size_--;
     }
   }
-  Node* minimum(Node* node) const {
+
+  static Node* minimum(Node* node) {
     if (!node) {
       return nullptr;
     }
@@ -120,67 +729,95 @@ class RBTree {
     return node;
   }
 
-  Node* successor(Node* node) const {
+  static Node* maximum(Node* node) {
+    if (!node) {
+      return nullptr;
+    }
+    while (node->right) {
+      node = node->right;
+    }
+    return node;
+  }
+
+  // Соседи узла в порядке обхода находятся по указателям на родителя,
+  // само дерево для этого не нужно
+  static Node* successor(Node* node) {
     if (node->right) {
       return minimum(node->right);
     }
-    Node* parent = node->parent;
+    Node* parent = node->getParent();
     while (parent && node == parent->right) {
       node = parent;
-      parent = parent->parent;
+      parent = parent->getParent();
     }
     return parent;
   }
 
-  const Node* successor(const Node* node) const {
-    if (node->right) {
-      return minimum(node->right);
+  static const Node* successor(const Node* node) {
+    return successor(const_cast<Node*>(node));
+  }
+
+  static Node* predecessor(Node* node) {
+    if (node->left) {
+      return maximum(node->left);
     }
-    const Node* parent = node->parent;
-    while (parent && node == parent->right) {
+    Node* parent = node->getParent();
+    while (parent && node == parent->left) {
       node = parent;
-      parent = parent->parent;
+      parent = parent->getParent();
     }
     return parent;
   }
 
+  static const Node* predecessor(const Node* node) {
+    return predecessor(const_cast<Node*>(node));
+  }
+
  private:
   Node* root_;
+  Node* leftmost_ = nullptr;
+  Node* rightmost_ = nullptr;
   size_t size_;
+  std::shared_ptr<node_pool> pool_;
+  Compare comp_;
 
-  void insertRec(Node* root, Node* new_node) {
-    if (new_node->data < root->data) {
-      if (root->left) {
-        insertRec(root->left, new_node);
-      } else {
-        root->left = new_node;
-        new_node->parent = root;
-      }
-    } else {
-      if (root->right) {
-        insertRec(root->right, new_node);
-      } else {
-        root->right = new_node;
-        new_node->parent = root;
-      }
+  template <typename... Args>
+  Node* createNode(Args&&... args) {
+    node_pool& pool = *this->pool();
+    Node* node = pool.allocate();
+    try {
+      new (node) Node(std::in_place, std::forward<Args>(args)...);
+    } catch (...) {
+      pool.deallocate(node);
+      throw;
     }
+    return node;
+  }
+
+  void destroyNode(Node* node) {
+    node->~Node();
+    pool_->deallocate(node);
   }
 
-  void fixInsert(Node* node) {
-    while (node->parent && node->parent->color == Color::RED) {
-      if (node->parent == node->parent->parent->left) {
+  // Возвращает true, если пришлось перекрасить красный корень, то есть
+  // черная высота дерева выросла на единицу
+  bool fixInsert(Node* node) {
+    while (node->getParent() && node->getParent()->getColor() == Color::RED) {
+      if (node->getParent() == node->getParent()->getParent()->left) {
         fixInsertLeftCase(node);
       } else {
         fixInsertRightCase(node);
       }
     }
     // Корень всегда черный
-    root_->color = Color::BLACK;
+    bool grown = root_->getColor() == Color::RED;
+    root_->setColor(Color::BLACK);
+    return grown;
   }
 
   void fixInsertLeftCase(Node*& node) {
-    Node* uncle = node->parent->parent->right;
-    if (uncle && uncle->color == Color::RED) {
+    Node* uncle = node->getParent()->getParent()->right;
+    if (uncle && uncle->getColor() == Color::RED) {
       handleRedUncle(node, uncle);
     } else {
       handleBlackUncleLeft(node);
@@ -188,8 +825,8 @@ class RBTree {
   }
 
   void fixInsertRightCase(Node*& node) {
-    Node* uncle = node->parent->parent->left;
-    if (uncle && uncle->color == Color::RED) {
+    Node* uncle = node->getParent()->getParent()->left;
+    if (uncle && uncle->getColor() == Color::RED) {
       handleRedUncle(node, uncle);
     } else {
       handleBlackUncleRight(node);
@@ -197,30 +834,30 @@ class RBTree {
   }
 
   void handleRedUncle(Node*& node, Node* uncle) {
-    node->parent->color = Color::BLACK;
-    uncle->color = Color::BLACK;
-    node->parent->parent->color = Color::RED;
-    node = node->parent->parent;
+    node->getParent()->setColor(Color::BLACK);
+    uncle->setColor(Color::BLACK);
+    node->getParent()->getParent()->setColor(Color::RED);
+    node = node->getParent()->getParent();
   }
 
   void handleBlackUncleLeft(Node*& node) {
-    if (node == node->parent->right) {
-      node = node->parent;
+    if (node == node->getParent()->right) {
+      node = node->getParent();
       rotateLeft(node);
     }
-    node->parent->color = Color::BLACK;
-    node->parent->parent->color = Color::RED;
-    rotateRight(node->parent->parent);
+    node->getParent()->setColor(Color::BLACK);
+    node->getParent()->getParent()->setColor(Color::RED);
+    rotateRight(node->getParent()->getParent());
   }
 
   void handleBlackUncleRight(Node*& node) {
-    if (node == node->parent->left) {
-      node = node->parent;
+    if (node == node->getParent()->left) {
+      node = node->getParent();
       rotateRight(node);
     }
-    node->parent->color = Color::BLACK;
-    node->parent->parent->color = Color::RED;
-    rotateLeft(node->parent->parent);
+    node->getParent()->setColor(Color::BLACK);
+    node->getParent()->getParent()->setColor(Color::RED);
+    rotateLeft(node->getParent()->getParent());
   }
 
   void rotate(Node* node, bool isLeft) {
@@ -230,120 +867,733 @@ class RBTree {
     if (isLeft) {
       node->right = child->left;
       if (child->left) {
-        child->left->parent = node;
+        child->left->setParent(node);
       }
     } else {
       node->left = child->right;
       if (child->right) {
-        child->right->parent = node;
+        child->right->setParent(node);
       }
     }
-    child->parent = node->parent;
-    if (!node->parent) {
+    child->setParent(node->getParent());
+    if (!node->getParent()) {
       root_ = child;
-    } else if (node == node->parent->left) {
-      node->parent->left = child;
+    } else if (node == node->getParent()->left) {
+      node->getParent()->left = child;
     } else {
-      node->parent->right = child;
+      node->getParent()->right = child;
     }
     if (isLeft) {
       child->left = node;
     } else {
       child->right = node;
     }
-    node->parent = child;
+    node->setParent(child);
+    if constexpr (OrderStatistic) {
+      // child занимает место node, размер всего поддерева не меняется
+      child->subtree_size = node->subtree_size;
+      node->subtree_size =
+          subtreeSize(node->left) + subtreeSize(node->right) + 1;
+    }
+  }
+
+  static size_t subtreeSize(const Node* node) {
+    if constexpr (OrderStatistic) {
+      return node ? node->subtree_size : 0;
+    } else {
+      return 0;
+    }
+  }
+
+  // Уменьшает размеры поддеревьев на пути от node до корня
+  void shrinkPath(Node* node) {
+    if constexpr (OrderStatistic) {
+      for (; node; node = node->getParent()) {
+        node->subtree_size--;
+      }
+    }
+  }
+
+  template <typename K>
+  size_t countLess(const K& key) const {
+    size_t result = 0;
+    for (Node* current = root_; current;) {
+      if (comp_(current->data, key)) {
+        result += subtreeSize(current->left) + 1;
+        current = current->right;
+      } else {
+        current = current->left;
+      }
+    }
+    return result;
+  }
+
+  template <typename K>
+  size_t countNotGreater(const K& key) const {
+    size_t result = 0;
+    for (Node* current = root_; current;) {
+      if (comp_(key, current->data)) {
+        current = current->left;
+      } else {
+        result += subtreeSize(current->left) + 1;
+        current = current->right;
+      }
+    }
+    return result;
   }
 
   void rotateLeft(Node* node) { rotate(node, true); }
 
   void rotateRight(Node* node) { rotate(node, false); }
 
-  Node* findRec(Node* node, const Key& value) {
-    if (!node || node->data == value) {
-      return node;
+  template <typename K>
+  Node* lowerBoundNode(const K& key) const {
+    Node* result = nullptr;
+    Node* current = root_;
+    while (current) {
+      if (comp_(current->data, key)) {
+        current = current->right;
+      } else {
+        result = current;
+        current = current->left;
+      }
     }
-    if (value < node->data) {
-      return findRec(node->left, value);
+    return result;
+  }
+
+  template <typename K>
+  Node* upperBoundNode(const K& key) const {
+    Node* result = nullptr;
+    Node* current = root_;
+    while (current) {
+      if (comp_(key, current->data)) {
+        result = current;
+        current = current->left;
+      } else {
+        current = current->right;
+      }
     }
-    return findRec(node->right, value);
+    return result;
   }
 
-  const Node* findRec(const Node* node, const Key& value) const {
-    if (!node || node->data == value) {
+  // Спуск идёт общим путём, пока не встретится равный ключ, дальше нижняя
+  // граница ищется в левом поддереве, а верхняя в правом
+  template <typename K>
+  std::pair<Node*, Node*> equalRangeNodes(const K& key) const {
+    Node* upper = nullptr;
+    Node* current = root_;
+    while (current) {
+      if (comp_(current->data, key)) {
+        current = current->right;
+      } else if (comp_(key, current->data)) {
+        upper = current;
+        current = current->left;
+      } else {
+        Node* lower = current;
+        for (Node* left = current->left; left;) {
+          if (comp_(left->data, key)) {
+            left = left->right;
+          } else {
+            lower = left;
+            left = left->left;
+          }
+        }
+        for (Node* right = current->right; right;) {
+          if (comp_(key, right->data)) {
+            upper = right;
+            right = right->left;
+          } else {
+            right = right->right;
+          }
+        }
+        return {lower, upper};
+      }
+    }
+    return {upper, upper};
+  }
+
+  template <typename K>
+  Node* findNode(const K& key) const {
+    if constexpr (AllowDuplicates || !std::is_scalar_v<Key>) {
+      Node* node = lowerBoundNode(key);
+      return (node && !comp_(key, node->data)) ? node : nullptr;
+    } else {
+      // Для дешёвых ключей оба сравнения вычисляются без короткого
+      // замыкания: выход по равенству почти всегда предсказывается верно,
+      // а выбор ребенка компилируется в cmov, так что промах кэша на
+      // следующем уровне не усугубляется промахом ветвления
+      Node* current = root_;
+      while (current) {
+        bool less = comp_(key, current->data);
+        bool greater = comp_(current->data, key);
+        if (!(less | greater)) {
+          break;
+        }
+        current = less ? current->left : current->right;
+      }
+      return current;
+    }
+  }
+
+  template <typename K>
+  size_t countKeys(const K& key) const {
+    if constexpr (!AllowDuplicates) {
+      return findNode(key) ? 1 : 0;
+    } else if constexpr (OrderStatistic) {
+      return countNotGreater(key) - countLess(key);
+    } else {
+      auto [first, last] = equalRangeNodes(key);
+      size_t cnt = 0;
+      for (const Node* node = first; node != last; node = successor(node)) {
+        cnt++;
+      }
+      return cnt;
+    }
+  }
+
+  // MoveKeys перемещает ключ из src, если перемещение не бросает
+  // исключений, иначе ключ копируется
+  template <bool MoveKeys, typename SrcNode>
+  Node* cloneNode(SrcNode* src, Node* parent) {
+    Node* node = nullptr;
+    if constexpr (MoveKeys) {
+      node = createNode(std::move_if_noexcept(src->data));
+    } else {
+      node = createNode(src->data);
+    }
+    node->setColor(src->getColor());
+    node->setParent(parent);
+    if constexpr (OrderStatistic) {
+      node->subtree_size = src->subtree_size;
+    }
+    return node;
+  }
+
+  // Строит в своём пуле дерево той же формы и раскраски, что и дерево с
+  // корнем src, и возвращает его корень. Обход идёт по указателям на
+  // родителя, поэтому не использует стек и не зависит от глубины дерева.
+  // При исключении построенная часть освобождается.
+  template <bool MoveKeys, typename SrcNode>
+  Node* copyShape(SrcNode* src) {
+    Node* root = cloneNode<MoveKeys>(src, nullptr);
+    try {
+      Node* dst = root;
+      while (src) {
+        if (src->left && !dst->left) {
+          dst->left = cloneNode<MoveKeys>(src->left, dst);
+          src = src->left;
+          dst = dst->left;
+        } else if (src->right && !dst->right) {
+          dst->right = cloneNode<MoveKeys>(src->right, dst);
+          src = src->right;
+          dst = dst->right;
+        } else {
+          src = src->getParent();
+          dst = dst->getParent();
+        }
+      }
+    } catch (...) {
+      clear(root);
+      throw;
+    }
+    return root;
+  }
+
+  // Переносит узлы в новый пул, которым дерево ни с кем не делится, за
+  // O(n). Форма, раскраска и ключи сохраняются; при исключении дерево
+  // остаётся прежним.
+  void moveToOwnPool() {
+    std::shared_ptr<node_pool> old_pool = std::move(pool_);
+    if (!root_) {
+      return;
+    }
+    Node* old_root = root_;
+    try {
+      root_ = copyShape<true>(old_root);
+    } catch (...) {
+      pool_ = std::move(old_pool);
+      throw;
+    }
+    leftmost_ = minimum(root_);
+    rightmost_ = maximum(root_);
+    // Старые узлы возвращаются в пул, из которого взяты
+    pool_.swap(old_pool);
+    clear(old_root);
+    pool_.swap(old_pool);
+  }
+
+  template <typename ForwardIt>
+  bool isSortedRange(ForwardIt first, ForwardIt last) const {
+    if constexpr (AllowDuplicates) {
+      return std::is_sorted(first, last, comp_);
+    } else {
+      // Для set соседние элементы должны строго возрастать
+      return std::adjacent_find(first, last, [this](const auto& lhs,
+                                                    const auto& rhs) {
+               return !comp_(lhs, rhs);
+             }) == last;
+    }
+  }
+
+  // Число черных узлов на пути от node до листа, включая сам node
+  static size_t blackHeight(const Node* node) {
+    size_t height = 0;
+    for (; node; node = node->left) {
+      if (node->getColor() == Color::BLACK) {
+        height++;
+      }
+    }
+    return height;
+  }
+
+  // Соединяет поддеревья left и right (корни могут быть красными) через
+  // узел mid, ключ которого лежит между ними. Черные высоты поддеревьев
+  // передаются явно. mid вешается на правый край более высокого left (или
+  // левый край right) на уровне с той же черной высотой, что у другого
+  // поддерева, после чего чинится как при вставке. Результат становится
+  // root_, возвращается его черная высота. Время O(|left_height -
+  // right_height| + 1).
+  size_t joinAt(Node* left, size_t left_height, Node* mid, Node* right,
+                size_t right_height) {
+    if (left) {
+      left->setParent(nullptr);
+      if (left->getColor() == Color::RED) {
+        left->setColor(Color::BLACK);
+        left_height++;
+      }
+    }
+    if (right) {
+      right->setParent(nullptr);
+      if (right->getColor() == Color::RED) {
+        right->setColor(Color::BLACK);
+        right_height++;
+      }
+    }
+    mid->setParent(nullptr);
+    if (left_height == right_height) {
+      mid->left = left;
+      mid->right = right;
+      mid->setColor(Color::BLACK);
+      if (left) left->setParent(mid);
+      if (right) right->setParent(mid);
+      if constexpr (OrderStatistic) {
+        mid->subtree_size = subtreeSize(left) + subtreeSize(right) + 1;
+      }
+      root_ = mid;
+      return left_height + 1;
+    }
+    bool along_right = left_height > right_height;
+    Node* tall = along_right ? left : right;
+    Node* low = along_right ? right : left;
+    size_t height = along_right ? left_height : right_height;
+    size_t target = along_right ? right_height : left_height;
+    Node* parent = nullptr;
+    Node* node = tall;
+    while (node && !(node->getColor() == Color::BLACK && height == target)) {
+      if (node->getColor() == Color::BLACK) {
+        height--;
+      }
+      parent = node;
+      node = along_right ? node->right : node->left;
+    }
+    mid->setColor(Color::RED);
+    mid->setParent(parent);
+    if (along_right) {
+      mid->left = node;
+      mid->right = low;
+      parent->right = mid;
+    } else {
+      mid->left = low;
+      mid->right = node;
+      parent->left = mid;
+    }
+    if (node) node->setParent(mid);
+    if (low) low->setParent(mid);
+    if constexpr (OrderStatistic) {
+      mid->subtree_size = subtreeSize(node) + subtreeSize(low) + 1;
+      for (Node* above = parent; above; above = above->getParent()) {
+        above->subtree_size += subtreeSize(low) + 1;
+      }
+    }
+    root_ = tall;
+    size_t tall_height = along_right ? left_height : right_height;
+    return fixInsert(mid) ? tall_height + 1 : tall_height;
+  }
+
+  // Размер левой части после split. В дереве с порядковой статистикой
+  // берётся из корня, иначе обе части обходятся попеременно, пока одна
+  // из них не закончится.
+  size_t countNodes(Node* left, Node* right, size_t total) const {
+    if constexpr (OrderStatistic) {
+      (void)right;
+      (void)total;
+      return subtreeSize(left);
+    } else {
+      Node* left_it = minimum(left);
+      Node* right_it = minimum(right);
+      size_t counted = 0;
+      while (left_it && right_it) {
+        left_it = successor(left_it);
+        right_it = successor(right_it);
+        counted++;
+      }
+      return left_it ? total - counted : counted;
+    }
+  }
+
+  // Other мал по сравнению с *this: m log n меньше n + m
+  bool isLopsided(const RBTree& other) const {
+    if (this == &other) {
+      return false;
+    }
+    size_t log_size = 1;
+    while ((size_t{1} << log_size) <= size_) {
+      log_size++;
+    }
+    return other.size_ * log_size < size_ + other.size_;
+  }
+
+  // Слияние упорядоченных обходов *this и other. Флаги задают, какие
+  // элементы попадают в результат: только из *this, общие (берётся узел
+  // *this) и только из other (копируются). Узлы *this переиспользуются,
+  // дерево перестраивается за O(n + m).
+  void mergeWith(const RBTree& other, bool keep_left, bool keep_common,
+                 bool keep_right) {
+    std::vector<Node*> result;
+    std::vector<Node*> discarded;
+    std::vector<Node*> created;
+    result.reserve(size_ + (keep_right ? other.size_ : 0));
+    discarded.reserve(keep_left && keep_common ? 0 : size_);
+    created.reserve(keep_right ? other.size_ : 0);
+    try {
+      Node* left = minimum(root_);
+      const Node* right = minimum(other.root_);
+      while (left || right) {
+        if (right && (!left || comp_(right->data, left->data))) {
+          if (keep_right) {
+            created.push_back(createNode(right->data));
+            result.push_back(created.back());
+          }
+          right = successor(right);
+        } else if (left && (!right || comp_(left->data, right->data))) {
+          (keep_left ? result : discarded).push_back(left);
+          left = successor(left);
+        } else {
+          (keep_common ? result : discarded).push_back(left);
+          left = successor(left);
+          right = successor(right);
+        }
+      }
+    } catch (...) {
+      for (Node* node : created) {
+        destroyNode(node);
+      }
+      throw;
+    }
+    for (Node* node : discarded) {
+      destroyNode(node);
+    }
+    size_t index = 0;
+    auto next = [&result, &index]() {
+      Node* node = result[index++];
+      node->left = nullptr;
+      node->right = nullptr;
       return node;
+    };
+    buildRoot(next, result.size());
+  }
+
+  // Собирает из count очередных узлов идеально сбалансированное дерево
+  // и делает его корнем. Прежние узлы должны быть уже освобождены или
+  // переданы через next.
+  template <typename NextNode>
+  void buildRoot(NextNode& next, size_t count) {
+    root_ = nullptr;
+    size_ = 0;
+    size_t red_depth = 0;
+    while ((size_t{2} << red_depth) <= count) {
+      red_depth++;
+    }
+    root_ = buildSubtree(next, count, 0, red_depth);
+    if (root_) {
+      root_->setParent(nullptr);
+      root_->setColor(Color::BLACK);
+    }
+    leftmost_ = minimum(root_);
+    rightmost_ = maximum(root_);
+    size_ = count;
+  }
+
+  // Строит поддерево из count очередных узлов, которые выдаёт next()
+  template <typename NextNode>
+  Node* buildSubtree(NextNode& next, size_t count, size_t depth,
+                     size_t red_depth) {
+    if (count == 0) {
+      return nullptr;
+    }
+    size_t left_count = (count - 1) / 2;
+    Node* left = buildSubtree(next, left_count, depth + 1, red_depth);
+    Node* node = nullptr;
+    try {
+      node = next();
+    } catch (...) {
+      clear(left);
+      throw;
+    }
+    node->left = left;
+    if (left) {
+      left->setParent(node);
     }
-    if (value < node->data) {
-      return findRec(node->left, value);
+    try {
+      node->right =
+          buildSubtree(next, count - left_count - 1, depth + 1, red_depth);
+    } catch (...) {
+      clear(node);
+      throw;
     }
-    return findRec(node->right, value);
+    if (node->right) {
+      node->right->setParent(node);
+    }
+    node->setColor(depth == red_depth ? Color::RED : Color::BLACK);
+    if constexpr (OrderStatistic) {
+      node->subtree_size = count;
+    }
+    return node;
   }
 
+  // Освобождает поддерево без рекурсии и без дополнительного стека: левый
+  // ребенок поворотом вправо поднимается на место текущего узла, а узел
+  // без левого ребенка удаляется с переходом в правое поддерево. Указатели
+  // на родителя не используются, поэтому подходит и для частично
+  // построенных поддеревьев.
   void clear(Node* node) {
-    if (!node) return;
-    clear(node->left);
-    clear(node->right);
-    delete node;
+    while (node) {
+      Node* left = node->left;
+      if (left) {
+        node->left = left->right;
+        left->right = node;
+        node = left;
+      } else {
+        Node* right = node->right;
+        destroyNode(node);
+        node = right;
+      }
+    }
+  }
+
+  // Место для нового ключа: будущий родитель и сторона либо, если
+  // дубликаты запрещены, уже имеющийся равный узел
+  struct Position {
+    Node* parent;
+    bool to_left;
+    Node* equal;
+  };
+
+  template <typename... Args>
+  std::pair<Node*, bool> placeNode(const Position& pos, Args&&... args) {
+    if (pos.equal) {
+      return {pos.equal, false};
+    }
+    Node* node = createNode(std::forward<Args>(args)...);
+    linkNode(pos.parent, pos.to_left, node);
+    return {node, true};
+  }
+
+  std::pair<Node*, bool> linkOrDestroy(const Position& pos, Node* node) {
+    if (pos.equal) {
+      destroyNode(node);
+      return {pos.equal, false};
+    }
+    linkNode(pos.parent, pos.to_left, node);
+    return {node, true};
+  }
+
+  Position findPosition(const Key& value) const {
+    if (rightmost_ && (AllowDuplicates ? !comp_(value, rightmost_->data)
+                                       : comp_(rightmost_->data, value))) {
+      return {rightmost_, false, nullptr};
+    }
+    Node* parent = nullptr;
+    Node* last_right = nullptr;  // ближайший меньший или равный value узел
+    Node* current = root_;
+    bool to_left = false;
+    while (current) {
+      parent = current;
+      to_left = comp_(value, current->data);
+      if (to_left) {
+        current = current->left;
+      } else {
+        last_right = current;
+        current = current->right;
+      }
+    }
+    if constexpr (!AllowDuplicates) {
+      // Запрещаем дубликаты для set: равный ключ может быть только
+      // у последнего узла, где спуск ушёл вправо
+      if (last_right && !comp_(last_right->data, value)) {
+        return {nullptr, false, last_right};
+      }
+    }
+    return {parent, to_left, nullptr};
+  }
+
+  // Место между соседями hint, если value туда подходит, иначе обычный
+  // поиск от корня
+  Position hintPosition(Node* hint, const Key& value) const {
+    Node* prev = nullptr;
+    Node* next = nullptr;
+    if (hint && !comp_(hint->data, value)) {
+      next = hint;
+      prev = hint == leftmost_ ? nullptr : predecessor(hint);
+    } else {
+      prev = hint ? hint : rightmost_;
+      next = hint && hint != rightmost_ ? successor(hint) : nullptr;
+    }
+    if constexpr (AllowDuplicates) {
+      if ((prev && comp_(value, prev->data)) ||
+          (next && comp_(next->data, value))) {
+        return findPosition(value);
+      }
+    } else {
+      if (prev && !comp_(prev->data, value)) {
+        return comp_(value, prev->data) ? findPosition(value)
+                                        : Position{nullptr, false, prev};
+      }
+      if (next && !comp_(value, next->data)) {
+        return comp_(next->data, value) ? findPosition(value)
+                                        : Position{nullptr, false, next};
+      }
+    }
+    // Место между prev и next: левый ребенок next, если он свободен,
+    // иначе правый ребенок prev — самого правого узла левого поддерева
+    if (next && !next->left) {
+      return {next, true, nullptr};
+    }
+    return {prev, false, nullptr};
+  }
+
+  // Перевешивать узлы между деревьями можно, только если память под них
+  // взята из одного пула. Пулы не потокобезопасны, поэтому общий пул
+  // появляется лишь по явному выбору пользователя, а не как побочный
+  // эффект merge или вставки handle.
+  bool samePool(const std::shared_ptr<node_pool>& other) const {
+    return pool_ && pool_ == other;
+  }
+
+  // Возвращает извлечённому узлу состояние только что созданного
+  static void resetLinks(Node* node) {
+    node->left = nullptr;
+    node->right = nullptr;
+    node->setParent(nullptr);
+    node->setColor(Color::RED);
+    if constexpr (OrderStatistic) {
+      node->subtree_size = 1;
+    }
+  }
+
+  // Подвешивает узел ребенком parent (nullptr — корень пустого дерева) и
+  // восстанавливает свойства дерева
+  void linkNode(Node* parent, bool to_left, Node* new_node) {
+    new_node->setParent(parent);
+    if (!parent) {
+      root_ = new_node;
+    } else if (to_left) {
+      parent->left = new_node;
+    } else {
+      parent->right = new_node;
+    }
+    // Новый минимум может появиться только левым ребенком прежнего,
+    // новый максимум — только правым
+    if (!parent || (to_left && parent == leftmost_)) {
+      leftmost_ = new_node;
+    }
+    if (!parent || (!to_left && parent == rightmost_)) {
+      rightmost_ = new_node;
+    }
+    if constexpr (OrderStatistic) {
+      for (Node* node = parent; node; node = node->getParent()) {
+        node->subtree_size++;
+      }
+    }
+    fixInsert(new_node);
+    size_++;
   }
 
   void eraseNode(Node* node) {
     if (!node) {
       return;
     }
+    unlinkNode(node);
+    destroyNode(node);
+  }
+
+  // Исключает узел из дерева с перебалансировкой, не освобождая его
+  void unlinkNode(Node* node) {
+    if (node == leftmost_) {
+      leftmost_ = successor(node);
+    }
+    if (node == rightmost_) {
+      rightmost_ = predecessor(node);
+    }
     Node* child = nullptr;
-    Node* parent = nullptr;
-    Color original_color = node->color;
+    Node* parent = node->getParent();
+    Color original_color = node->getColor();
 
     if (!node->left) {
       // У узла нет левого ребенка
+      shrinkPath(node->getParent());
       child = node->right;
       transplant(node, node->right);
     } else if (!node->right) {
       // У узла нет правого ребенка
+      shrinkPath(node->getParent());
       child = node->left;
       transplant(node, node->left);
     } else {
       // У узла есть оба ребенка
       Node* successor = minimum(node->right);
-      original_color = successor->color;
+      shrinkPath(successor->getParent());
+      original_color = successor->getColor();
       child = successor->right;
-      parent = successor->parent;
+      parent = successor->getParent();
 
-      if (successor->parent != node) {
+      if (successor->getParent() != node) {
         transplant(successor, successor->right);
         successor->right = node->right;
-        successor->right->parent = successor;
+        successor->right->setParent(successor);
       } else {
         parent = successor;
       }
 
       transplant(node, successor);
       successor->left = node->left;
-      successor->left->parent = successor;
-      successor->color = node->color;
+      successor->left->setParent(successor);
+      successor->setColor(node->getColor());
+      if constexpr (OrderStatistic) {
+        successor->subtree_size = node->subtree_size;
+      }
     }
 
-    delete node;
-
     if (original_color == Color::BLACK) {
       fixDelete(child, parent);
     }
   }
 
   void transplant(Node* u, Node* v) {
-    if (!u->parent) {
+    if (!u->getParent()) {
       root_ = v;
-    } else if (u == u->parent->left) {
-      u->parent->left = v;
+    } else if (u == u->getParent()->left) {
+      u->getParent()->left = v;
     } else {
-      u->parent->right = v;
+      u->getParent()->right = v;
     }
     if (v) {
-      v->parent = u->parent;
+      v->setParent(u->getParent());
     }
   }
 
   void fixDelete(Node* node, Node* parent) {
-    while (node != root_ && (!node || node->color == Color::BLACK)) {
+    while (node != root_ && (!node || node->getColor() == Color::BLACK)) {
       if (!parent) {
         break;
       }
@@ -354,32 +1604,32 @@ class RBTree {
           break;
         }
 
-        if (sibling->color == Color::RED) {
+        if (sibling->getColor() == Color::RED) {
           // Брат красный
-          sibling->color = Color::BLACK;
-          parent->color = Color::RED;
+          sibling->setColor(Color::BLACK);
+          parent->setColor(Color::RED);
           rotateLeft(parent);
           sibling = parent->right;
         }
 
-        if ((!sibling->left || sibling->left->color == Color::BLACK) &&
-            (!sibling->right || sibling->right->color == Color::BLACK)) {
+        if ((!sibling->left || sibling->left->getColor() == Color::BLACK) &&
+            (!sibling->right || sibling->right->getColor() == Color::BLACK)) {
           // Оба ребенка брата черные
-          sibling->color = Color::RED;
+          sibling->setColor(Color::RED);
           node = parent;
-          parent = node->parent;
+          parent = node->getParent();
         } else {
-          if (!sibling->right || sibling->right->color == Color::BLACK) {
+          if (!sibling->right || sibling->right->getColor() == Color::BLACK) {
             // Левый ребенок брата красный, правый черный
-            sibling->left->color = Color::BLACK;
-            sibling->color = Color::RED;
+            sibling->left->setColor(Color::BLACK);
+            sibling->setColor(Color::RED);
             rotateRight(sibling);
             sibling = parent->right;
           }
           //  Правый ребенок брата красный
-          sibling->color = parent->color;
-          parent->color = Color::BLACK;
-          sibling->right->color = Color::BLACK;
+          sibling->setColor(parent->getColor());
+          parent->setColor(Color::BLACK);
+          sibling->right->setColor(Color::BLACK);
           rotateLeft(parent);
           node = root_;
         }
@@ -389,32 +1639,32 @@ class RBTree {
           break;
         }
 
-        if (sibling->color == Color::RED) {
+        if (sibling->getColor() == Color::RED) {
           // Брат красный
-          sibling->color = Color::BLACK;
-          parent->color = Color::RED;
+          sibling->setColor(Color::BLACK);
+          parent->setColor(Color::RED);
           rotateRight(parent);
           sibling = parent->left;
         }
 
-        if ((!sibling->right || sibling->right->color == Color::BLACK) &&
-            (!sibling->left || sibling->left->color == Color::BLACK)) {
+        if ((!sibling->right || sibling->right->getColor() == Color::BLACK) &&
+            (!sibling->left || sibling->left->getColor() == Color::BLACK)) {
           // Оба ребенка брата черные
-          sibling->color = Color::RED;
+          sibling->setColor(Color::RED);
           node = parent;
-          parent = node->parent;
+          parent = node->getParent();
         } else {
-          if (!sibling->left || sibling->left->color == Color::BLACK) {
+          if (!sibling->left || sibling->left->getColor() == Color::BLACK) {
             // Правый ребенок брата красный, левый черный
-            sibling->right->color = Color::BLACK;
-            sibling->color = Color::RED;
+            sibling->right->setColor(Color::BLACK);
+            sibling->setColor(Color::RED);
             rotateLeft(sibling);
             sibling = parent->left;
           }
           //  Левый ребенок брата красный
-          sibling->color = parent->color;
-          parent->color = Color::BLACK;
-          sibling->left->color = Color::BLACK;
+          sibling->setColor(parent->getColor());
+          parent->setColor(Color::BLACK);
+          sibling->left->setColor(Color::BLACK);
           rotateRight(parent);
           node = root_;
         }
@@ -422,7 +1672,7 @@ class RBTree {
     }
 
     if (node) {
-      node->color = Color::BLACK;
+      node->setColor(Color::BLACK);
     }
   }
 };
@@ -0,0 +1,58 @@
+#ifndef _BENCH_H_
+#define _BENCH_H_
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace bench {
+
+// Время выполнения f в миллисекундах
+template <typename F>
+double measure(F&& f) {
+  auto start = std::chrono::steady_clock::now();
+  f();
+  auto finish = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(finish - start).count();
+}
+
+// Миллионов операций в секунду
+inline double mops(size_t ops, double ms) {
+  return ms > 0 ? static_cast<double>(ops) / (ms * 1000.0) : 0.0;
+}
+
+// Размеры берутся из аргументов командной строки, иначе используются
+// значения по умолчанию
+inline std::vector<size_t> sizes(int argc, char** argv,
+                                 std::vector<size_t> defaults) {
+  if (argc < 2) {
+    return defaults;
+  }
+  std::vector<size_t> result;
+  for (int i = 1; i < argc; ++i) {
+    result.push_back(std::strtoull(argv[i], nullptr, 10));
+  }
+  return result;
+}
+
+inline std::vector<uint64_t> randomKeys(size_t n, uint64_t seed = 42) {
+  std::mt19937_64 gen(seed);
+  std::vector<uint64_t> keys(n);
+  for (auto& key : keys) {
+    key = gen();
+  }
+  return keys;
+}
+
+// Не даёт компилятору выбросить вычисленное значение
+template <typename T>
+void doNotOptimize(const T& value) {
+  asm volatile("" : : "g"(&value) : "memory");
+}
+
+}  // namespace bench
+
+#endif
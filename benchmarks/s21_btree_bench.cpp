@@ -0,0 +1,59 @@
+// Пропускная способность find/insert/erase/обхода для s21::set<uint64_t>
+// на RBTree и на B+-дереве (btree_set), а также для std::set.
+// Запуск: ./s21_btree_bench [размер ...], по умолчанию 1M и 10M ключей.
+#include <set>
+
+#include "../set/s21_set.h"
+#include "bench.h"
+
+template <typename Set>
+void run(const char* name, const std::vector<uint64_t>& keys,
+         const std::vector<uint64_t>& queries) {
+  Set s;
+  double insert_ms = bench::measure([&] {
+    for (uint64_t key : keys) {
+      s.insert(key);
+    }
+  });
+  size_t found = 0;
+  double find_ms = bench::measure([&] {
+    for (uint64_t key : queries) {
+      found += s.find(key) != s.end();
+    }
+  });
+  uint64_t sum = 0;
+  double iterate_ms = bench::measure([&] {
+    for (uint64_t key : s) {
+      sum += key;
+    }
+  });
+  double erase_ms = bench::measure([&] {
+    for (size_t i = 0; i < keys.size(); i += 2) {
+      s.erase(s.find(keys[i]));
+    }
+  });
+  bench::doNotOptimize(found);
+  bench::doNotOptimize(sum);
+  std::printf("%-12s %12zu %10.2f %10.2f %10.2f %10.2f\n", name, keys.size(),
+              bench::mops(keys.size(), insert_ms),
+              bench::mops(queries.size(), find_ms),
+              bench::mops(keys.size(), iterate_ms),
+              bench::mops(keys.size() / 2, erase_ms));
+}
+
+int main(int argc, char** argv) {
+  std::printf("%-12s %12s %10s %10s %10s %10s\n", "container", "keys",
+              "ins Mop/s", "find", "iterate", "erase");
+  for (size_t n : bench::sizes(argc, argv, {1000000, 10000000})) {
+    auto keys = bench::randomKeys(n);
+    // Половина запросов попадает в множество, половина промахивается
+    auto queries = bench::randomKeys(n, 7);
+    for (size_t i = 0; i < n; i += 2) {
+      queries[i] = keys[queries[i] % n];
+    }
+    run<s21::set<uint64_t>>("s21::set", keys, queries);
+    run<s21::btree_set<uint64_t>>("btree_set", keys, queries);
+    run<std::set<uint64_t>>("std::set", keys, queries);
+  }
+  return 0;
+}
@@ -0,0 +1,126 @@
+// Пропускная способность читателей при одном постоянно пишущем потоке:
+// s21::concurrent_set против s21::set под std::mutex и под
+// std::shared_mutex. Каждый читатель в течение фиксированного времени
+// ищет случайные ключи, писатель без пауз вставляет и удаляет ключи
+// вне предзаполненного диапазона. Итог — суммарные Mops/s всех читателей
+// и число записей писателя.
+// Запуск: ./s21_concurrent_set_bench [читателей ...]
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+
+#include "../set/s21_concurrent_set.h"
+#include "../set/s21_set.h"
+#include "bench.h"
+
+static constexpr size_t kKeys = 100000;
+static constexpr auto kDuration = std::chrono::milliseconds(300);
+
+// s21::set под одним мьютексом для чтения и записи
+class MutexSet {
+ public:
+  bool contains(uint64_t key) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return set_.contains(key);
+  }
+  void insert(uint64_t key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    set_.insert(key);
+  }
+  void erase(uint64_t key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    set_.erase(set_.find(key));
+  }
+
+ private:
+  mutable std::mutex mutex_;
+  s21::set<uint64_t> set_;
+};
+
+// s21::set под std::shared_mutex: читатели берут разделяемую блокировку
+class SharedMutexSet {
+ public:
+  bool contains(uint64_t key) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return set_.contains(key);
+  }
+  void insert(uint64_t key) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    set_.insert(key);
+  }
+  void erase(uint64_t key) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    set_.erase(set_.find(key));
+  }
+
+ private:
+  mutable std::shared_mutex mutex_;
+  s21::set<uint64_t> set_;
+};
+
+struct Result {
+  double reader_mops;
+  size_t writes;
+};
+
+template <typename Set>
+static Result run(size_t readers) {
+  Set set;
+  for (uint64_t key = 0; key < kKeys; ++key) {
+    set.insert(key * 2);
+  }
+  std::atomic<bool> done{false};
+  std::atomic<size_t> reads{0};
+  size_t writes = 0;
+
+  std::vector<std::thread> threads;
+  for (size_t r = 0; r < readers; ++r) {
+    threads.emplace_back([&, r] {
+      std::mt19937_64 gen(r + 1);
+      size_t local = 0;
+      size_t found = 0;
+      while (!done.load(std::memory_order_relaxed)) {
+        found += set.contains(gen() % (kKeys * 2));
+        local++;
+      }
+      bench::doNotOptimize(found);
+      reads.fetch_add(local);
+    });
+  }
+  std::thread writer([&] {
+    // Нечётные ключи за пределами предзаполненных: размер почти не меняется
+    uint64_t key = 1;
+    while (!done.load(std::memory_order_relaxed)) {
+      set.insert(key);
+      set.erase(key);
+      key = (key + 2) % (kKeys * 2);
+      writes += 2;
+    }
+  });
+  double ms_time = bench::measure([&] {
+    std::this_thread::sleep_for(kDuration);
+    done = true;
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    writer.join();
+  });
+  return {bench::mops(reads.load(), ms_time), writes};
+}
+
+int main(int argc, char** argv) {
+  std::printf("hardware threads: %u\n", std::thread::hardware_concurrency());
+  std::printf("%8s %14s %10s %14s %10s %14s %10s\n", "readers",
+              "left-right", "writes", "mutex", "writes", "shared_mutex",
+              "writes");
+  for (size_t readers : bench::sizes(argc, argv, {1, 2, 4, 8, 16, 32, 64})) {
+    Result lr = run<s21::concurrent_set<uint64_t>>(readers);
+    Result mx = run<MutexSet>(readers);
+    Result sh = run<SharedMutexSet>(readers);
+    std::printf("%8zu %14.2f %10zu %14.2f %10zu %14.2f %10zu\n", readers,
+                lr.reader_mops, lr.writes, mx.reader_mops, mx.writes,
+                sh.reader_mops, sh.writes);
+  }
+  return 0;
+}
@@ -0,0 +1,50 @@
+// Вставка случайных ключей в s21::map с крупными значениями: ключ
+// uint64_t или std::string (вне SSO), значение — структура на 256 байт.
+// Повороты перевешивают узлы и не трогают пары ключ-значение, поэтому
+// цена поворота не зависит от размера значения. Для сравнения — std::map.
+// Запуск: ./s21_map_insert_bench [размер ...]
+#include <map>
+#include <string>
+
+#include "../map/s21_map.h"
+#include "bench.h"
+
+struct LargeStruct {
+  uint64_t payload[32] = {};
+};
+
+template <typename Map, typename Key>
+static double insertAll(const std::vector<Key>& keys) {
+  Map m;
+  double ms_time = bench::measure([&] {
+    for (const Key& key : keys) {
+      m.insert(std::make_pair(key, LargeStruct{}));
+    }
+  });
+  bench::doNotOptimize(m.size());
+  return ms_time;
+}
+
+int main(int argc, char** argv) {
+  std::printf("%10s %16s %12s %12s\n", "keys", "key type", "s21 Mops",
+              "std Mops");
+  for (size_t n : bench::sizes(argc, argv, {100000, 1000000})) {
+    auto numbers = bench::randomKeys(n);
+    std::vector<std::string> strings;
+    strings.reserve(n);
+    for (uint64_t key : numbers) {
+      strings.push_back("configuration/entry/" + std::to_string(key));
+    }
+    std::printf(
+        "%10zu %16s %12.2f %12.2f\n", n, "uint64_t",
+        bench::mops(n, insertAll<s21::map<uint64_t, LargeStruct>>(numbers)),
+        bench::mops(n, insertAll<std::map<uint64_t, LargeStruct>>(numbers)));
+    std::printf(
+        "%10zu %16s %12.2f %12.2f\n", n, "std::string",
+        bench::mops(n,
+                    insertAll<s21::map<std::string, LargeStruct>>(strings)),
+        bench::mops(n,
+                    insertAll<std::map<std::string, LargeStruct>>(strings)));
+  }
+  return 0;
+}
@@ -0,0 +1,60 @@
+// Поиск в s21::map<std::string, int> по ключам, заданным как
+// std::string_view (ключи длиннее буфера SSO). С обычным std::less
+// каждый запрос строит временную std::string, с прозрачным std::less<>
+// строки сравниваются напрямую. Отдельно — поиск по uint64_t.
+// Запуск: ./s21_map_lookup_bench [размер ...]
+#include <string>
+#include <string_view>
+
+#include "../map/s21_map.h"
+#include "bench.h"
+
+static constexpr size_t kLookups = 1000000;
+
+template <typename Map, typename Probe>
+static double lookups(Map& m, const std::vector<Probe>& probes,
+                      size_t& found) {
+  return bench::measure([&] {
+    for (size_t i = 0; i < kLookups; ++i) {
+      found += m.contains(probes[i % probes.size()]);
+    }
+  });
+}
+
+int main(int argc, char** argv) {
+  std::printf("%10s %16s %16s %14s\n", "keys", "string Mops",
+              "string_view Mops", "uint64 Mops");
+  for (size_t n : bench::sizes(argc, argv, {1000, 100000, 1000000})) {
+    auto numbers = bench::randomKeys(n);
+    std::vector<std::string> strings;
+    strings.reserve(n);
+    for (uint64_t key : numbers) {
+      strings.push_back("configuration/entry/" + std::to_string(key));
+    }
+    std::vector<std::string_view> views(strings.begin(), strings.end());
+
+    s21::map<std::string, int> plain;
+    s21::map<std::string, int, std::less<>> transparent;
+    s21::map<uint64_t, int> by_number;
+    for (size_t i = 0; i < n; ++i) {
+      plain.insert(strings[i], 0);
+      transparent.insert(strings[i], 0);
+      by_number.insert(numbers[i], 0);
+    }
+
+    size_t found = 0;
+    double plain_ms = bench::measure([&] {
+      for (size_t i = 0; i < kLookups; ++i) {
+        found += plain.contains(std::string(views[i % n]));
+      }
+    });
+    double transparent_ms = lookups(transparent, views, found);
+    double number_ms = lookups(by_number, numbers, found);
+    bench::doNotOptimize(found);
+    std::printf("%10zu %16.2f %16.2f %14.2f\n", n,
+                bench::mops(kLookups, plain_ms),
+                bench::mops(kLookups, transparent_ms),
+                bench::mops(kLookups, number_ms));
+  }
+  return 0;
+}
@@ -0,0 +1,36 @@
+// Стоимость s21::map::size() в зависимости от размера карты. Счётчик
+// элементов поддерживается при изменениях, поэтому время вызова не должно
+// расти с размером; для сравнения приведено время полного обхода, во
+// сколько обходился size() раньше.
+// Запуск: ./s21_map_size_bench [размер ...]
+#include "../map/s21_map.h"
+#include "bench.h"
+
+static constexpr size_t kCalls = 10000000;
+
+int main(int argc, char** argv) {
+  std::printf("%12s %14s %14s\n", "entries", "size() ns", "walk ms");
+  for (size_t n : bench::sizes(argc, argv, {1000, 100000, 1000000, 5000000})) {
+    s21::map<uint64_t, uint64_t> m;
+    for (uint64_t key : bench::randomKeys(n)) {
+      m.insert(key, key);
+    }
+    size_t total = 0;
+    double size_ms = bench::measure([&] {
+      for (size_t i = 0; i < kCalls; ++i) {
+        total += m.size();
+        bench::doNotOptimize(total);
+      }
+    });
+    size_t walked = 0;
+    double walk_ms = bench::measure([&] {
+      for (auto it = m.begin(); it != m.end(); ++it) {
+        walked++;
+      }
+    });
+    bench::doNotOptimize(walked);
+    std::printf("%12zu %14.2f %14.2f\n", m.size(),
+                size_ms * 1e6 / static_cast<double>(kCalls), walk_ms);
+  }
+  return 0;
+}
@@ -0,0 +1,58 @@
+// Вставка в s21::multiset<uint64_t> потоков по возрастанию, по убыванию и
+// в случайном порядке: обычная вставка и вставка с подсказкой, где
+// подсказкой служит итератор на предыдущий вставленный элемент. Для
+// сравнения — std::multiset с той же подсказкой.
+// Запуск: ./s21_multiset_hint_bench [размер ...]
+#include <algorithm>
+#include <set>
+
+#include "../multiset/s21_multiset.h"
+#include "bench.h"
+
+template <typename Multiset>
+static double plainInsert(const std::vector<uint64_t>& keys) {
+  Multiset ms;
+  double ms_time = bench::measure([&] {
+    for (uint64_t key : keys) {
+      ms.insert(key);
+    }
+  });
+  bench::doNotOptimize(ms.size());
+  return ms_time;
+}
+
+template <typename Multiset>
+static double hintedInsert(const std::vector<uint64_t>& keys) {
+  Multiset ms;
+  double ms_time = bench::measure([&] {
+    auto hint = ms.end();
+    for (uint64_t key : keys) {
+      hint = ms.insert(hint, key);
+    }
+  });
+  bench::doNotOptimize(ms.size());
+  return ms_time;
+}
+
+int main(int argc, char** argv) {
+  std::printf("%12s %10s %12s %12s %12s %12s\n", "keys", "stream",
+              "insert Mops", "hint Mops", "std Mops", "std hint");
+  for (size_t n : bench::sizes(argc, argv, {100000, 1000000, 10000000})) {
+    auto random = bench::randomKeys(n);
+    auto sorted = random;
+    std::sort(sorted.begin(), sorted.end());
+    auto reversed = std::vector<uint64_t>(sorted.rbegin(), sorted.rend());
+    const std::pair<const char*, const std::vector<uint64_t>*> streams[] = {
+        {"sorted", &sorted}, {"reverse", &reversed}, {"random", &random}};
+    for (const auto& [name, keys] : streams) {
+      using Ours = s21::multiset<uint64_t>;
+      using Std = std::multiset<uint64_t>;
+      std::printf("%12zu %10s %12.2f %12.2f %12.2f %12.2f\n", n, name,
+                  bench::mops(n, plainInsert<Ours>(*keys)),
+                  bench::mops(n, hintedInsert<Ours>(*keys)),
+                  bench::mops(n, plainInsert<Std>(*keys)),
+                  bench::mops(n, hintedInsert<Std>(*keys)));
+    }
+  }
+  return 0;
+}
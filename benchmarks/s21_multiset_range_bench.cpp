@@ -0,0 +1,60 @@
+// Задержка диапазонных запросов в s21::multiset<uint64_t>: линейный проход
+// от begin() (прежняя реализация lower_bound/upper_bound) против спуска по
+// дереву. Запуск: ./s21_multiset_range_bench [размер ...]
+#include "../multiset/s21_multiset.h"
+#include "bench.h"
+
+using Multiset = s21::multiset<uint64_t>;
+
+// Поведение до перехода на спуск по дереву
+static std::pair<Multiset::iterator, Multiset::iterator> linearEqualRange(
+    Multiset& ms, uint64_t key) {
+  auto lower = ms.begin();
+  while (lower != ms.end() && *lower < key) {
+    ++lower;
+  }
+  auto upper = lower;
+  while (upper != ms.end() && *upper <= key) {
+    ++upper;
+  }
+  return {lower, upper};
+}
+
+int main(int argc, char** argv) {
+  std::printf("%12s %10s %14s %14s %14s\n", "keys", "queries", "linear us/q",
+              "tree us/q", "count us/q");
+  for (size_t n : bench::sizes(argc, argv, {100000, 1000000, 10000000})) {
+    Multiset ms;
+    auto keys = bench::randomKeys(n);
+    for (size_t i = 0; i < n; ++i) {
+      // Каждый ключ встречается в среднем дважды
+      ms.insert(keys[i] % (n / 2 + 1));
+    }
+    auto probes = bench::randomKeys(n < 1000000 ? 200 : 20, 7);
+    size_t sink = 0;
+    double linear_ms = bench::measure([&] {
+      for (uint64_t probe : probes) {
+        auto range = linearEqualRange(ms, probe % (n / 2 + 1));
+        sink += range.first != range.second;
+      }
+    });
+    auto tree_probes = bench::randomKeys(100000, 7);
+    double tree_ms = bench::measure([&] {
+      for (uint64_t probe : tree_probes) {
+        auto range = ms.equal_range(probe % (n / 2 + 1));
+        sink += range.first != range.second;
+      }
+    });
+    double count_ms = bench::measure([&] {
+      for (uint64_t probe : tree_probes) {
+        sink += ms.count(probe % (n / 2 + 1));
+      }
+    });
+    bench::doNotOptimize(sink);
+    std::printf("%12zu %10zu %14.2f %14.3f %14.3f\n", n, tree_probes.size(),
+                linear_ms * 1000.0 / probes.size(),
+                tree_ms * 1000.0 / tree_probes.size(),
+                count_ms * 1000.0 / tree_probes.size());
+  }
+  return 0;
+}
@@ -0,0 +1,100 @@
+// Снимки множества из 1M ключей: s21::persistent_set против копирования
+// s21::set. Делается 1000 версий, каждая после одной вставки, и все они
+// удерживаются одновременно. Память считается по всем выделениям через
+// operator new (с учётом служебного размера блока malloc). Для s21::set
+// измеряется одна копия, 1000 копий — её стоимость, умноженная на 1000:
+// честно держать их не хватит памяти.
+// Запуск: ./s21_persistent_set_bench [размер ...]
+#include <malloc.h>
+
+#include <new>
+
+#include "../set/s21_persistent_set.h"
+#include "../set/s21_set.h"
+#include "bench.h"
+
+static size_t allocated_bytes = 0;
+
+void* operator new(size_t size) {
+  void* ptr = std::malloc(size);
+  if (!ptr) {
+    throw std::bad_alloc();
+  }
+  allocated_bytes += malloc_usable_size(ptr);
+  return ptr;
+}
+
+void operator delete(void* ptr) noexcept {
+  if (ptr) {
+    allocated_bytes -= malloc_usable_size(ptr);
+  }
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept { operator delete(ptr); }
+
+// Слэбы пула RBTree выделяются с явным выравниванием
+void* operator new(size_t size, std::align_val_t align) {
+  void* ptr = std::aligned_alloc(static_cast<size_t>(align), size);
+  if (!ptr) {
+    throw std::bad_alloc();
+  }
+  allocated_bytes += malloc_usable_size(ptr);
+  return ptr;
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept {
+  operator delete(ptr);
+}
+
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept {
+  operator delete(ptr);
+}
+
+static constexpr size_t kVersions = 1000;
+
+int main(int argc, char** argv) {
+  std::printf("%10s %10s %14s %14s %14s %14s\n", "keys", "versions",
+              "persist ms", "persist MB", "copies ms", "copies MB");
+  for (size_t n : bench::sizes(argc, argv, {1000000})) {
+    auto keys = bench::randomKeys(n + kVersions);
+    double persistent_ms = 0;
+    double persistent_mb = 0;
+    {
+      s21::persistent_set<uint64_t> base;
+      for (size_t i = 0; i < n; ++i) {
+        base = base.insert(keys[i]);
+      }
+      size_t before = allocated_bytes;
+      std::vector<s21::persistent_set<uint64_t>> versions;
+      versions.reserve(kVersions);
+      persistent_ms = bench::measure([&] {
+        versions.push_back(base);
+        for (size_t v = 1; v < kVersions; ++v) {
+          versions.push_back(versions.back().insert(keys[n + v]));
+        }
+      });
+      persistent_mb = static_cast<double>(allocated_bytes - before) / 1e6;
+      bench::doNotOptimize(versions.back().size());
+    }
+    double copy_ms = 0;
+    double copy_mb = 0;
+    {
+      s21::set<uint64_t> base;
+      for (size_t i = 0; i < n; ++i) {
+        base.insert(keys[i]);
+      }
+      size_t before = allocated_bytes;
+      copy_ms = bench::measure([&] {
+        s21::set<uint64_t> copy(base);
+        copy_mb = static_cast<double>(allocated_bytes - before) / 1e6;
+        copy.insert(keys[n]);
+        bench::doNotOptimize(copy.size());
+      });
+    }
+    std::printf("%10zu %10zu %14.2f %14.1f %14.0f %14.0f\n", n, kVersions,
+                persistent_ms, persistent_mb, copy_ms * kVersions,
+                copy_mb * kVersions);
+  }
+  return 0;
+}
@@ -0,0 +1,74 @@
+// Задержка find/insert/clear для s21::RBTree на больших деревьях.
+// Для сравнения find измеряется и рекурсивным спуском (как в старом
+// findRec), clear — на дереве с разделяемым пулом и на строковых ключах,
+// где узлы освобождаются по одному обходом без рекурсии.
+// Запуск: ./s21_rbtree_latency_bench [размер ...], по умолчанию 1M и 10M.
+#include <string>
+
+#include "../RBtree/s21_rbtree.h"
+#include "bench.h"
+
+using Tree = s21::RBTree<uint64_t>;
+using StringTree = s21::RBTree<std::string>;
+
+const Tree::Node* findRecursive(const Tree::Node* node, uint64_t key) {
+  if (!node || node->data == key) {
+    return node;
+  }
+  return findRecursive(key < node->data ? node->left : node->right, key);
+}
+
+double nsPerOp(size_t ops, double ms) {
+  return ops ? ms * 1e6 / static_cast<double>(ops) : 0.0;
+}
+
+void run(const std::vector<uint64_t>& keys) {
+  size_t n = keys.size();
+  // Второе дерево делит пул с первым, поэтому clear не может просто
+  // вернуть слэбы и освобождает узлы по одному
+  Tree tree;
+  Tree neighbour(tree.pool());
+  double insert_ms = bench::measure([&] {
+    for (uint64_t key : keys) {
+      tree.insert(key);
+    }
+  });
+  neighbour.insert(0);
+
+  size_t found = 0;
+  for (uint64_t key : keys) {
+    found += tree.find(key) != nullptr;
+  }
+  double find_ms = bench::measure([&] {
+    for (uint64_t key : keys) {
+      found += tree.find(key) != nullptr;
+    }
+  });
+  double find_rec_ms = bench::measure([&] {
+    for (uint64_t key : keys) {
+      found += findRecursive(tree.getRoot(), key) != nullptr;
+    }
+  });
+  bench::doNotOptimize(found);
+  double clear_ms = bench::measure([&] { tree.clear(); });
+
+  StringTree strings;
+  for (uint64_t key : keys) {
+    strings.insert(std::to_string(key));
+  }
+  double clear_str_ms = bench::measure([&] { strings.clear(); });
+
+  std::printf("%12zu %10.1f %10.1f %10.1f %10.1f %10.1f %10.1f\n", n,
+              nsPerOp(n, insert_ms), nsPerOp(n, find_ms),
+              nsPerOp(n, find_rec_ms), nsPerOp(n, clear_ms), clear_ms,
+              clear_str_ms);
+}
+
+int main(int argc, char** argv) {
+  std::printf("%12s %10s %10s %10s %10s %10s %10s\n", "keys", "ins ns",
+              "find ns", "rec ns", "clear ns", "clear ms", "str ms");
+  for (size_t n : bench::sizes(argc, argv, {1000000, 10000000})) {
+    run(bench::randomKeys(n));
+  }
+  return 0;
+}
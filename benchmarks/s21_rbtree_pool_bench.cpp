@@ -0,0 +1,44 @@
+// Пропускная способность insert/erase для s21::set<uint64_t> на пуле узлов
+// и для std::set (отдельный new/delete на каждый узел).
+// Запуск: ./s21_rbtree_pool_bench [размер ...], по умолчанию 1M и 10M ключей.
+#include <set>
+
+#include "../set/s21_set.h"
+#include "bench.h"
+
+template <typename Set>
+void run(const char* name, const std::vector<uint64_t>& keys) {
+  Set s;
+  double insert_ms = bench::measure([&] {
+    for (uint64_t key : keys) {
+      s.insert(key);
+    }
+  });
+  double erase_ms = bench::measure([&] {
+    for (size_t i = 0; i < keys.size(); i += 2) {
+      s.erase(s.find(keys[i]));
+    }
+  });
+  // Повторная вставка после удаления: узлы берутся из free-list
+  double churn_ms = bench::measure([&] {
+    for (size_t i = 0; i < keys.size(); i += 2) {
+      s.insert(keys[i]);
+    }
+  });
+  double clear_ms = bench::measure([&] { s.clear(); });
+  std::printf("%-10s %12zu %10.2f %10.2f %10.2f %10.1f\n", name, keys.size(),
+              bench::mops(keys.size(), insert_ms),
+              bench::mops(keys.size() / 2, erase_ms),
+              bench::mops(keys.size() / 2, churn_ms), clear_ms);
+}
+
+int main(int argc, char** argv) {
+  std::printf("%-10s %12s %10s %10s %10s %10s\n", "container", "keys",
+              "ins Mop/s", "era Mop/s", "re-ins", "clear ms");
+  for (size_t n : bench::sizes(argc, argv, {1000000, 10000000})) {
+    auto keys = bench::randomKeys(n);
+    run<s21::set<uint64_t>>("s21::set", keys);
+    run<std::set<uint64_t>>("std::set", keys);
+  }
+  return 0;
+}
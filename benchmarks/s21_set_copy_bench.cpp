@@ -0,0 +1,37 @@
+// Время копирования s21::set<uint64_t>: прежнее копирование вставками,
+// построение из отсортированного диапазона и структурное копирование.
+// Запуск: ./s21_set_copy_bench [размер ...], например 1000000 10000000
+// 50000000 (для 50M нужно около 6 ГБ памяти).
+#include "../set/s21_set.h"
+#include "bench.h"
+
+using Set = s21::set<uint64_t>;
+
+int main(int argc, char** argv) {
+  std::printf("%12s %14s %14s %14s\n", "keys", "insert ms", "sorted ms",
+              "clone ms");
+  for (size_t n : bench::sizes(argc, argv, {1000000, 10000000})) {
+    Set original;
+    for (uint64_t key : bench::randomKeys(n)) {
+      original.insert(key);
+    }
+    double insert_ms = bench::measure([&] {
+      Set copy;
+      for (uint64_t key : original) {
+        copy.insert(key);
+      }
+      bench::doNotOptimize(copy.size());
+    });
+    double sorted_ms = bench::measure([&] {
+      Set copy(original.begin(), original.end());
+      bench::doNotOptimize(copy.size());
+    });
+    double clone_ms = bench::measure([&] {
+      Set copy(original);
+      bench::doNotOptimize(copy.size());
+    });
+    std::printf("%12zu %14.1f %14.1f %14.1f\n", original.size(), insert_ms,
+                sorted_ms, clone_ms);
+  }
+  return 0;
+}
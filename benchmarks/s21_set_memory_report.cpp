@@ -0,0 +1,46 @@
+// Память на элемент для s21::set с обычными и компактными узлами.
+// Считается всё, что выделено пулом (включая ещё не занятые узлы
+// последнего слэба), без учёта данных строк вне SSO.
+// Запуск: ./s21_set_memory_report [размер ...], по умолчанию 1M ключей.
+#include <string>
+
+#include "../set/s21_set.h"
+#include "bench.h"
+
+template <typename Set, typename MakeKey>
+void report(const char* name, size_t n, MakeKey make_key) {
+  auto pool = std::make_shared<typename Set::node_pool>();
+  Set s(pool);
+  for (size_t i = 0; i < n; ++i) {
+    s.insert(make_key(i));
+  }
+  using Node = typename std::remove_pointer_t<decltype(pool->allocate())>;
+  size_t slot = sizeof(Node) < sizeof(void*) ? sizeof(void*) : sizeof(Node);
+  double per_element = static_cast<double>(pool->capacity() * slot) /
+                       static_cast<double>(s.size());
+  std::printf("%-28s %10zu %10zu %12.1f\n", name, s.size(), sizeof(Node),
+              per_element);
+}
+
+int main(int argc, char** argv) {
+  std::printf("%-28s %10s %10s %12s\n", "container", "elements", "node B",
+              "B/element");
+  for (size_t n : bench::sizes(argc, argv, {1000000})) {
+    auto keys = bench::randomKeys(n);
+    auto as_int = [&](size_t i) { return static_cast<int>(keys[i]); };
+    auto as_u64 = [&](size_t i) { return keys[i]; };
+    // Короткие строки помещаются в буфер SSO и не выделяют память
+    auto as_str = [&](size_t i) {
+      return std::to_string(keys[i] % 1000000007);
+    };
+
+    report<s21::set<int>>("set<int>", n, as_int);
+    report<s21::compact_set<int>>("compact_set<int>", n, as_int);
+    report<s21::set<uint64_t>>("set<uint64_t>", n, as_u64);
+    report<s21::compact_set<uint64_t>>("compact_set<uint64_t>", n, as_u64);
+    report<s21::set<std::string>>("set<std::string>", n, as_str);
+    report<s21::compact_set<std::string>>("compact_set<std::string>", n,
+                                          as_str);
+  }
+  return 0;
+}
@@ -5,8 +5,8 @@
 
 namespace s21 {
 
-template <typename Key, typename Value>
-class map : public BinaryAVLTree<Key, Value> {
+template <typename Key, typename Value, typename Compare = std::less<Key>>
+class map : public BinaryAVLTree<Key, Value, Compare> {
  public:
   class MapIterator;
   class ConstMapIterator;
@@ -19,10 +19,14 @@ class map : public BinaryAVLTree<Key, Value> {
   using iterator = MapIterator;
   using const_iterator = ConstMapIterator;
   using size_type = size_t;
-
-  map() : BinaryAVLTree<Key, Value>() {};
-  map(const map &other) : BinaryAVLTree<Key, Value>(other) {};
-  map(map &&other) noexcept : BinaryAVLTree<Key, Value>(std::move(other)) {};
+  using key_compare = Compare;
+
+  map() : BinaryAVLTree<Key, Value, Compare>() {};
+  explicit map(const Compare &comp)
+      : BinaryAVLTree<Key, Value, Compare>(comp) {};
+  map(const map &other) : BinaryAVLTree<Key, Value, Compare>(other) {};
+  map(map &&other) noexcept
+      : BinaryAVLTree<Key, Value, Compare>(std::move(other)) {};
   map(std::initializer_list<value_type> const &items);
   ~map() = default;
 
@@ -2,22 +2,23 @@
 
 namespace s21 {
 
-template <typename Key, typename Value>
-map<Key, Value>::map(std::initializer_list<value_type> const &items) {
+template <typename Key, typename Value, typename Compare>
+map<Key, Value, Compare>::map(std::initializer_list<value_type> const &items) {
   for (auto i = items.begin(); i != items.end(); ++i) {
-    BinaryAVLTree<Key, Value>::insert(*i);
+    BinaryAVLTree<Key, Value, Compare>::insert(*i);
   }
 }
 
-template <typename Key, typename Value>
-map<Key, Value> &map<Key, Value>::operator=(const map &other) {
-  BinaryAVLTree<Key, Value>::operator=(other);
+template <typename Key, typename Value, typename Compare>
+map<Key, Value, Compare> &map<Key, Value, Compare>::operator=(
+    const map &other) {
+  BinaryAVLTree<Key, Value, Compare>::operator=(other);
   return *this;
 }
 
-template <typename Key, typename Value>
-map<Key, Value> &map<Key, Value>::operator=(map &&other) {
-  BinaryAVLTree<Key, Value>::operator=(std::move(other));
+template <typename Key, typename Value, typename Compare>
+map<Key, Value, Compare> &map<Key, Value, Compare>::operator=(map &&other) {
+  BinaryAVLTree<Key, Value, Compare>::operator=(std::move(other));
   return *this;
 }
 }  // namespace s21
@@ -0,0 +1,73 @@
+#ifndef S21_PERSISTENT_MAP_H
+#define S21_PERSISTENT_MAP_H
+
+#include <functional>
+#include <initializer_list>
+
+#include "../BinaryAVLTree/PersistentAVLTree.h"
+
+namespace s21 {
+
+// Immutable map: every modifier returns a new map and leaves this one as
+// it was. Copying is an O(1) snapshot; versions share unchanged nodes
+template <typename Key, typename Value, typename Compare = std::less<Key>>
+class persistent_map {
+  using Tree = PersistentAVLTree<Key, Value, Compare>;
+
+ public:
+  using key_type = Key;
+  using mapped_type = Value;
+  using value_type = typename Tree::value_type;
+  using const_reference = const value_type&;
+  using iterator = typename Tree::const_iterator;
+  using const_iterator = typename Tree::const_iterator;
+  using size_type = size_t;
+  using key_compare = Compare;
+
+  persistent_map() = default;
+  explicit persistent_map(const Compare& comp) : tree(comp) {}
+  persistent_map(std::initializer_list<value_type> const& items) {
+    for (const auto& item : items) {
+      tree = tree.insert(item.first, item.second);
+    }
+  }
+
+  const_iterator begin() const { return tree.begin(); }
+  const_iterator end() const { return tree.end(); }
+
+  const mapped_type& at(const Key& key) const { return tree.at(key); }
+  bool contains(const Key& key) const { return tree.contains(key); }
+  const value_type* find(const Key& key) const { return tree.find(key); }
+  bool empty() const { return tree.empty(); }
+  size_type size() const { return tree.size(); }
+  key_compare key_comp() const { return tree.key_comp(); }
+
+  [[nodiscard]] persistent_map insert(const value_type& value) const {
+    return persistent_map(tree.insert(value.first, value.second));
+  }
+  [[nodiscard]] persistent_map insert(const Key& key,
+                                      const mapped_type& obj) const {
+    return persistent_map(tree.insert(key, obj));
+  }
+  [[nodiscard]] persistent_map insert_or_assign(
+      const Key& key, const mapped_type& obj) const {
+    return persistent_map(tree.insert_or_assign(key, obj));
+  }
+  [[nodiscard]] persistent_map erase(const Key& key) const {
+    return persistent_map(tree.erase(key));
+  }
+
+  // True when both maps are the same version (share the root node)
+  bool shares_root(const persistent_map& other) const {
+    return tree.getRoot() == other.tree.getRoot();
+  }
+
+ private:
+  explicit persistent_map(Tree newTree) : tree(std::move(newTree)) {}
+
+  Tree tree;
+};
+
+}  // namespace s21
+
+#endif
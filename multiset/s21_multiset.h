@@ -1,26 +1,45 @@
 #ifndef S21_MULTISET_H
 #define S21_MULTISET_H
 
+#include <functional>
 #include <initializer_list>
+#include <iterator>
 #include <utility>
 
+#include "../BTree/s21_btree.h"
 #include "../RBtree/s21_rbtree.h"
 
 namespace s21 {
 
-template <typename Key>
+// Tree позволяет выбрать вариант дерева, например RBTree с порядковой
+// статистикой или BTree (см. order_statistic_multiset и btree_multiset
+// ниже). Операции, которых нет у выбранного дерева, недоступны.
+template <typename Key, typename Compare = std::less<Key>,
+          typename Tree = RBTree<Key, true, Compare>>
 class multiset {
+  // Используем RBTree с дубликатами
+  using MultiSetTree = Tree;
+
  public:
   using key_type = Key;
   using value_type = Key;
   using reference = value_type&;
   using const_reference = const value_type&;
   using size_type = size_t;
+  using key_compare = Compare;
+  using value_compare = Compare;
+  using node_pool = typename MultiSetTree::node_pool;
+  using node_type = typename MultiSetTree::node_handle;
 
   class Iterator {
    public:
-    Iterator(typename RBTree<Key, true>::Node* node,
-             const RBTree<Key, true>* tree)
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = Key;
+    using difference_type = std::ptrdiff_t;
+    using pointer = value_type*;
+    using reference = value_type&;
+
+    Iterator(typename MultiSetTree::Node* node, const MultiSetTree* tree)
         : node_(node), tree_(tree) {}
 
     reference operator*() const {
@@ -32,11 +51,30 @@ class multiset {
 
     Iterator& operator++() {
       if (node_) {
-        node_ = tree_->successor(node_);
+        node_ = MultiSetTree::successor(node_);
       }
       return *this;
     }
 
+    Iterator operator++(int) {
+      Iterator old = *this;
+      ++*this;
+      return old;
+    }
+
+    // Из end() переходит к последнему элементу, указатель на который
+    // хранится в дереве
+    Iterator& operator--() {
+      node_ = node_ ? MultiSetTree::predecessor(node_) : tree_->last();
+      return *this;
+    }
+
+    Iterator operator--(int) {
+      Iterator old = *this;
+      --*this;
+      return old;
+    }
+
     bool operator==(const Iterator& other) const {
       return node_ == other.node_;
     }
@@ -46,14 +84,22 @@ class multiset {
     }
 
    private:
-    typename RBTree<Key, true>::Node* node_;
-    const RBTree<Key, true>* tree_;
+    friend class multiset;
+
+    typename MultiSetTree::Node* node_;
+    const MultiSetTree* tree_;
   };
 
   class ConstIterator {
    public:
-    ConstIterator(const typename RBTree<Key, true>::Node* node,
-                  const RBTree<Key, true>* tree)
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = Key;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const value_type*;
+    using reference = const value_type&;
+
+    ConstIterator(const typename MultiSetTree::Node* node,
+                  const MultiSetTree* tree)
         : node_(node), tree_(tree) {}
 
     const_reference operator*() const {
@@ -65,11 +111,28 @@ class multiset {
 
     ConstIterator& operator++() {
       if (node_) {
-        node_ = tree_->successor(node_);
+        node_ = MultiSetTree::successor(node_);
       }
       return *this;
     }
 
+    ConstIterator operator++(int) {
+      ConstIterator old = *this;
+      ++*this;
+      return old;
+    }
+
+    ConstIterator& operator--() {
+      node_ = node_ ? MultiSetTree::predecessor(node_) : tree_->last();
+      return *this;
+    }
+
+    ConstIterator operator--(int) {
+      ConstIterator old = *this;
+      --*this;
+      return old;
+    }
+
     bool operator==(const ConstIterator& other) const {
       return node_ == other.node_;
     }
@@ -79,29 +142,46 @@ class multiset {
     }
 
    private:
-    const typename RBTree<Key, true>::Node* node_;
-    const RBTree<Key, true>* tree_;
+    const typename MultiSetTree::Node* node_;
+    const MultiSetTree* tree_;
   };
 
   using iterator = Iterator;
   using const_iterator = ConstIterator;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
 
   multiset() = default;
 
-  multiset(std::initializer_list<value_type> const& items) {
-    for (const auto& item : items) {
-      insert(item);
-    }
+  explicit multiset(const Compare& comp) : tree_(comp) {}
+
+  // Узлы берутся из пула, который можно разделить с другими контейнерами.
+  // Пул не потокобезопасен: контейнеры с общим пулом нельзя менять из
+  // разных потоков одновременно. Зато merge и вставка node_type между ними
+  // перевешивают узлы без выделения памяти.
+  explicit multiset(std::shared_ptr<node_pool> pool,
+                    const Compare& comp = Compare())
+      : tree_(std::move(pool), comp) {}
+
+  multiset(std::initializer_list<value_type> const& items,
+           const Compare& comp = Compare())
+      : tree_(comp) {
+    tree_.insertRange(items.begin(), items.end());
   }
 
-  multiset(const multiset& other) {
-    for (const auto& item : other) {
-      insert(item);
-    }
+  // Отсортированный диапазон строится за O(n), иначе вставка по одному
+  template <typename InputIt, typename = typename std::iterator_traits<
+                                  InputIt>::iterator_category>
+  multiset(InputIt first, InputIt last, const Compare& comp = Compare())
+      : tree_(comp) {
+    tree_.insertRange(first, last);
   }
 
+  // Копируется структура дерева целиком, без повторных вставок
+  multiset(const multiset& other) : tree_(other.tree_) {}
+
   multiset(multiset&& other) : tree_(std::move(other.tree_)) {
-    other.tree_ = RBTree<Key, true>();
+    other.tree_ = MultiSetTree(tree_.key_comp());
   }
 
   ~multiset() = default;
@@ -109,17 +189,14 @@ class multiset {
   multiset& operator=(multiset&& other) {
     if (this != &other) {
       tree_ = std::move(other.tree_);
-      other.tree_ = RBTree<Key, true>();
+      other.tree_ = MultiSetTree(tree_.key_comp());
     }
     return *this;
   }
 
   multiset& operator=(const multiset& other) {
     if (this != &other) {
-      clear();
-      for (const auto& item : other) {
-        insert(item);
-      }
+      tree_ = other.tree_;
     }
     return *this;
   }
@@ -132,9 +209,49 @@ class multiset {
 
   void clear() { tree_.clear(); }
 
+  // Наименьший и наибольший элементы за O(1). Контейнер не должен быть
+  // пустым.
+  const_reference front() const { return tree_.first()->data; }
+  const_reference back() const { return tree_.last()->data; }
+
+  // Удаляют наименьший или наибольший элемент, на пустом контейнере
+  // ничего не делают. Вместе с front()/back() позволяют использовать
+  // контейнер как двустороннюю очередь с приоритетом.
+  void pop_min() { tree_.popFirst(); }
+  void pop_max() { tree_.popLast(); }
+
   iterator insert(const value_type& value) {
-    tree_.insert(value);
-    return iterator(tree_.find(value), &tree_);
+    return iterator(tree_.insert(value).first, &tree_);
+  }
+
+  iterator insert(value_type&& value) {
+    return iterator(tree_.insert(std::move(value)).first, &tree_);
+  }
+
+  // Ключ конструируется из args сразу в узле дерева
+  template <typename... Args>
+  iterator emplace(Args&&... args) {
+    return iterator(tree_.emplace(std::forward<Args>(args)...).first, &tree_);
+  }
+
+  // Вставка с подсказкой: если value встаёт непосредственно перед hint,
+  // узел подвешивается рядом без спуска от корня. Для потока ключей по
+  // возрастанию достаточно передавать end(). Равные ключи, как и при
+  // обычной вставке, остаются в порядке поступления, если подсказка верна.
+  iterator insert(iterator hint, const value_type& value) {
+    return iterator(tree_.insertHint(hint.node_, value).first, &tree_);
+  }
+
+  iterator insert(iterator hint, value_type&& value) {
+    return iterator(tree_.insertHint(hint.node_, std::move(value)).first,
+                    &tree_);
+  }
+
+  template <typename... Args>
+  iterator emplace_hint(iterator hint, Args&&... args) {
+    return iterator(
+        tree_.emplaceHint(hint.node_, std::forward<Args>(args)...).first,
+        &tree_);
   }
 
   iterator find(const Key& key) {
@@ -142,69 +259,192 @@ class multiset {
     return iterator(node, &tree_);
   }
 
-  void erase(iterator pos) {
-    if (pos != end()) {
-      tree_.erase(*pos);
+  // Удаляет именно тот элемент, на который указывает pos, без поиска по
+  // ключу, и возвращает итератор на следующий
+  iterator erase(iterator pos) {
+    if (pos == end()) {
+      return pos;
     }
+    return iterator(tree_.eraseAt(pos.node_), &tree_);
+  }
+
+  // Удаляет [first, last) и возвращает итератор на элемент, который стоял
+  // на месте last
+  iterator erase(iterator first, iterator last) {
+    if (first == last) {
+      return last;
+    }
+    return iterator(tree_.eraseRange(first.node_, last.node_), &tree_);
+  }
+
+  // Гетерогенный поиск: доступен, если Compare::is_transparent определён
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  iterator find(const K& key) {
+    return iterator(tree_.find(key), &tree_);
   }
 
-  bool contains(const Key& key) const { return tree_.find(key) != nullptr; }
+  bool contains(const Key& key) const { return tree_.contains(key); }
+
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  bool contains(const K& key) const {
+    return tree_.contains(key);
+  }
 
   size_type count(const Key& key) const { return tree_.count(key); }
+
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  size_type count(const K& key) const {
+    return tree_.count(key);
+  }
+
+  // Порядковая статистика: доступна, если Tree хранит размеры поддеревьев.
+  // k-й по порядку элемент (с нуля) или end(), если k >= size()
+  iterator nth_element(size_type k) {
+    return iterator(tree_.select(k), &tree_);
+  }
+
+  // Количество элементов, строго меньших key
+  size_type rank(const Key& key) const { return tree_.rank(key); }
+
+  // Количество элементов в отрезке [lo, hi]
+  size_type count_range(const Key& lo, const Key& hi) const {
+    return tree_.count_range(lo, hi);
+  }
+
+  key_compare key_comp() const { return tree_.key_comp(); }
+
+  value_compare value_comp() const { return tree_.key_comp(); }
+
   std::pair<iterator, iterator> equal_range(const Key& key) {
-    auto lower = lower_bound(key);
-    auto upper = upper_bound(key);
-    return std::make_pair(lower, upper);
+    auto [lower, upper] = tree_.equal_range(key);
+    return std::make_pair(iterator(lower, &tree_), iterator(upper, &tree_));
+  }
+
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  std::pair<iterator, iterator> equal_range(const K& key) {
+    auto [lower, upper] = tree_.equal_range(key);
+    return std::make_pair(iterator(lower, &tree_), iterator(upper, &tree_));
   }
 
   iterator lower_bound(const Key& key) {
-    auto it = begin();
-    while (it != end() && *it < key) {
-      ++it;
-    }
-    return it;
+    return iterator(tree_.lower_bound(key), &tree_);
+  }
+
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  iterator lower_bound(const K& key) {
+    return iterator(tree_.lower_bound(key), &tree_);
   }
 
   iterator upper_bound(const Key& key) {
-    auto it = begin();
-    while (it != end() && *it <= key) {
-      ++it;
-    }
-    return it;
+    return iterator(tree_.upper_bound(key), &tree_);
   }
 
-  void merge(multiset& other) {
-    for (auto it = other.begin(); it != other.end();) {
-      auto next = it;
-      ++next;
-      insert(*it);
-      other.erase(it);
-      it = next;
-    }
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  iterator upper_bound(const K& key) {
+    return iterator(tree_.upper_bound(key), &tree_);
   }
 
+  // Переносятся все элементы other, равные встают после имеющихся. Узлы
+  // перевешиваются без выделения памяти, только если контейнеры созданы
+  // над общим пулом, иначе элементы перемещаются в новые узлы (у BTree —
+  // всегда), и пулы контейнеров остаются независимыми.
+  void merge(multiset& other) { tree_.merge(other.tree_); }
+
+  // Извлекает элемент вместе с узлом; пустой handle для end()
+  node_type extract(iterator pos) {
+    return pos == end() ? node_type() : tree_.extract(pos.node_);
+  }
+
+  node_type extract(const Key& key) { return tree_.extract(key); }
+
+  // Узел из того же пула подвешивается как есть; из чужого пула ключ
+  // перемещается в новый узел, а сам узел возвращается в свой пул.
+  // Вставка извлечённого узла всегда удаётся; для пустого handle — end()
+  iterator insert(node_type&& node) {
+    return iterator(tree_.insert(std::move(node)).first, &tree_);
+  }
+
+  // Теоретико-множественные операции, результат записывается в *this.
+  // Кратности учитываются так же, как в std::set_union и т.п. Работают за
+  // O(n + m), а при маленьком other — за O(m log n).
+  void union_with(const multiset& other) { tree_.unionWith(other.tree_); }
+
+  void intersect_with(const multiset& other) {
+    tree_.intersectWith(other.tree_);
+  }
+
+  void difference(const multiset& other) { tree_.differenceWith(other.tree_); }
+
+  void symmetric_difference(const multiset& other) {
+    tree_.symmetricDifferenceWith(other.tree_);
+  }
+
+  // Оставляет в контейнере элементы меньше key, а остальные возвращает
+  // отдельным контейнером за O(log n + размер меньшей части). Меньшая часть
+  // получает собственный пул узлов, так что части не связаны друг с другом
+  // и могут использоваться из разных потоков.
+  multiset split_at(const Key& key) { return multiset(tree_.split(key)); }
+
+  // Переносит в конец контейнера все элементы other, которые должны быть
+  // не меньше всех элементов этого контейнера, за O(log n + log m).
+  // При пересечении диапазонов бросает std::invalid_argument.
+  void join(multiset& other) { tree_.join(other.tree_); }
+
   void swap(multiset& other) { std::swap(tree_, other.tree_); }
 
-  iterator begin() { return iterator(tree_.minimum(tree_.getRoot()), &tree_); }
+  iterator begin() { return iterator(tree_.first(), &tree_); }
   const_iterator begin() const {
-    return const_iterator(tree_.minimum(tree_.getRoot()), &tree_);
+    return const_iterator(tree_.first(), &tree_);
   }
 
   iterator end() { return iterator(nullptr, &tree_); }
   const_iterator end() const { return const_iterator(nullptr, &tree_); }
 
+  // Обход с конца: rbegin() не спускается по дереву, каждый шаг — переход к
+  // предшественнику, так что k наибольших элементов читаются за O(k)
+  reverse_iterator rbegin() { return reverse_iterator(end()); }
+  const_reverse_iterator rbegin() const {
+    return const_reverse_iterator(end());
+  }
+
+  reverse_iterator rend() { return reverse_iterator(begin()); }
+  const_reverse_iterator rend() const {
+    return const_reverse_iterator(begin());
+  }
+
   template <typename... Args>
   std::vector<iterator> insert_many(Args&&... args) {
     std::vector<iterator> results;
-    (results.push_back(insert(std::forward<Args>(args))), ...);
+    (results.push_back(emplace(std::forward<Args>(args))), ...);
     return results;
   }
 
  private:
-  using MultiSetTree = RBTree<Key, true>;  // Используем RBTree с дубликатами
+  explicit multiset(MultiSetTree&& tree) : tree_(std::move(tree)) {}
+
   MultiSetTree tree_;
 };
 
+template <typename Key, typename Compare = std::less<Key>>
+using order_statistic_multiset =
+    multiset<Key, Compare, RBTree<Key, true, Compare, true>>;
+
+// Узлы с цветом в бите указателя на родителя: меньше памяти на элемент
+template <typename Key, typename Compare = std::less<Key>>
+using compact_multiset =
+    multiset<Key, Compare, RBTree<Key, true, Compare, false, true>>;
+
+// B+-дерево вместо красно-черного: быстрее поиск и обход, но вставка и
+// удаление делают недействительными итераторы на соседние элементы
+template <typename Key, typename Compare = std::less<Key>>
+using btree_multiset = multiset<Key, Compare, BTree<Key, true, Compare>>;
+
 }  // namespace s21
 
 #endif  // S21_MULTISET_H
\ No newline at end of file
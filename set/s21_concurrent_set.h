@@ -0,0 +1,187 @@
+#ifndef S21_CONCURRENT_SET_H
+#define S21_CONCURRENT_SET_H
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+
+#include "../RBtree/s21_rbtree.h"
+
+namespace s21 {
+
+// Множество для сценария «много читателей, редкие записи» по схеме
+// Left-Right: дерево хранится в двух экземплярах. Читатели всегда идут в
+// тот, на который указывает left_right_, и не ждут ни писателя, ни друг
+// друга: чтение — это отметка в счётчике читателей, обычный спуск по
+// RBTree и снятие отметки. Писатель меняет второй экземпляр, переводит
+// читателей на него, дожидается ухода читателей со старого и повторяет
+// ту же операцию на нём. Поэтому запись стоит двух операций над деревом
+// и ожидания текущих читателей, а памяти нужно вдвое больше.
+//
+// Писатели сериализуются мьютексом. Итераторов нет: читатель не может
+// удерживать узел дольше одного вызова. Для произвольного чтения служит
+// read(), которому передаётся константное дерево.
+template <typename Key, typename Compare = std::less<Key>>
+class concurrent_set {
+ public:
+  using key_type = Key;
+  using value_type = Key;
+  using size_type = size_t;
+  using key_compare = Compare;
+  using tree_type = RBTree<Key, false, Compare>;
+
+  concurrent_set() = default;
+
+  explicit concurrent_set(const Compare& comp)
+      : instances_{tree_type(comp), tree_type(comp)} {}
+
+  concurrent_set(const concurrent_set&) = delete;
+  concurrent_set& operator=(const concurrent_set&) = delete;
+
+  // Чтение без ожидания: число шагов не зависит от других потоков
+  bool contains(const Key& key) const {
+    return read([&key](const tree_type& tree) { return tree.contains(key); });
+  }
+
+  // Копия найденного элемента: ссылка на узел после выхода из чтения
+  // могла бы указывать на уже удалённый писателем узел
+  std::optional<Key> find(const Key& key) const {
+    return read([&key](const tree_type& tree) -> std::optional<Key> {
+      const auto* node = tree.find(key);
+      return node ? std::optional<Key>(node->data) : std::nullopt;
+    });
+  }
+
+  size_type size() const {
+    return read([](const tree_type& tree) { return tree.size(); });
+  }
+
+  bool empty() const { return size() == 0; }
+
+  // Вызывает f(const tree_type&) на согласованном снимке. f не должна
+  // сохранять указатели на узлы и вызывать методы записи этого множества.
+  template <typename F>
+  decltype(auto) read(F&& f) const {
+    ReadGuard guard(*this);
+    return std::forward<F>(f)(
+        instances_[left_right_.load(std::memory_order_seq_cst)]);
+  }
+
+  bool insert(const Key& key) {
+    return write([&key](tree_type& tree) { return tree.insert(key).second; });
+  }
+
+  // Удаляет элемент, возвращает число удалённых (0 или 1)
+  size_type erase(const Key& key) {
+    return write([&key](tree_type& tree) -> size_type {
+      auto* node = tree.find(key);
+      if (!node) {
+        return 0;
+      }
+      tree.eraseAt(node);
+      return 1;
+    });
+  }
+
+  void clear() {
+    write([](tree_type& tree) {
+      tree.clear();
+      return true;
+    });
+  }
+
+ private:
+  // Счётчик читателей, разбитый на полосы по кэш-линиям, чтобы потоки на
+  // разных ядрах не делили одну линию. Полоса выбирается по id потока.
+  class ReadIndicator {
+   public:
+    size_t arrive() {
+      thread_local const size_t stripe =
+          std::hash<std::thread::id>()(std::this_thread::get_id()) %
+          kStripes;
+      stripes_[stripe].readers.fetch_add(1, std::memory_order_seq_cst);
+      return stripe;
+    }
+
+    void depart(size_t stripe) {
+      stripes_[stripe].readers.fetch_sub(1, std::memory_order_seq_cst);
+    }
+
+    bool empty() const {
+      for (const Stripe& stripe : stripes_) {
+        if (stripe.readers.load(std::memory_order_seq_cst) != 0) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+   private:
+    static constexpr size_t kStripes = 64;
+
+    struct alignas(64) Stripe {
+      std::atomic<size_t> readers{0};
+    };
+
+    Stripe stripes_[kStripes];
+  };
+
+  // Отметка читателя в индикаторе текущей версии на время одного чтения
+  class ReadGuard {
+   public:
+    explicit ReadGuard(const concurrent_set& set)
+        : indicator_(
+              set.indicators_[set.version_.load(std::memory_order_seq_cst)]),
+          stripe_(indicator_.arrive()) {}
+
+    ~ReadGuard() { indicator_.depart(stripe_); }
+
+    ReadGuard(const ReadGuard&) = delete;
+    ReadGuard& operator=(const ReadGuard&) = delete;
+
+   private:
+    ReadIndicator& indicator_;
+    size_t stripe_;
+  };
+
+  // Операция применяется к обоим экземплярам по очереди, результат
+  // берётся из первого применения (оба экземпляра одинаковы)
+  template <typename F>
+  auto write(F&& f) {
+    std::lock_guard<std::mutex> lock(writer_);
+    int current = left_right_.load(std::memory_order_relaxed);
+    auto result = f(instances_[1 - current]);
+    left_right_.store(1 - current, std::memory_order_seq_cst);
+    waitForReaders();
+    f(instances_[current]);
+    return result;
+  }
+
+  // Переключает версию и ждёт, пока уйдут читатели, которые могли
+  // прийти до смены left_right_ и читать старый экземпляр
+  void waitForReaders() {
+    int previous = version_.load(std::memory_order_relaxed);
+    int next = 1 - previous;
+    while (!indicators_[next].empty()) {
+      std::this_thread::yield();
+    }
+    version_.store(next, std::memory_order_seq_cst);
+    while (!indicators_[previous].empty()) {
+      std::this_thread::yield();
+    }
+  }
+
+  tree_type instances_[2];
+  std::atomic<int> left_right_{0};
+  std::atomic<int> version_{0};
+  mutable ReadIndicator indicators_[2];
+  std::mutex writer_;
+};
+
+}  // namespace s21
+
+#endif  // S21_CONCURRENT_SET_H
@@ -0,0 +1,96 @@
+#ifndef S21_PERSISTENT_SET_H
+#define S21_PERSISTENT_SET_H
+
+#include <functional>
+#include <initializer_list>
+#include <utility>
+
+#include "../RBtree/s21_persistent_rbtree.h"
+
+namespace s21 {
+
+// Неизменяемое множество: insert и erase возвращают новое множество, а
+// исходное остаётся прежним. Копия — это снимок за O(1), версии делят
+// все неизменённые узлы (см. PersistentRBTree).
+template <typename Key, typename Compare = std::less<Key>>
+class persistent_set {
+  using Tree = PersistentRBTree<Key, Compare>;
+
+ public:
+  using key_type = Key;
+  using value_type = Key;
+  using reference = const value_type&;
+  using const_reference = const value_type&;
+  using size_type = size_t;
+  using key_compare = Compare;
+  using iterator = typename Tree::const_iterator;
+  using const_iterator = typename Tree::const_iterator;
+
+  persistent_set() = default;
+  explicit persistent_set(const Compare& comp) : tree_(comp) {}
+
+  persistent_set(std::initializer_list<value_type> const& items) {
+    for (const auto& item : items) {
+      tree_ = tree_.insert(item);
+    }
+  }
+
+  const_iterator begin() const { return tree_.begin(); }
+  const_iterator end() const { return tree_.end(); }
+
+  bool empty() const { return tree_.empty(); }
+  size_type size() const { return tree_.size(); }
+
+  key_compare key_comp() const { return tree_.key_comp(); }
+
+  const_iterator find(const Key& key) const { return tree_.find(key); }
+
+  bool contains(const Key& key) const { return tree_.contains(key); }
+  const_iterator lower_bound(const Key& key) const {
+    return tree_.lower_bound(key);
+  }
+
+  [[nodiscard]] persistent_set insert(const value_type& value) const {
+    return persistent_set(tree_.insert(value));
+  }
+
+  [[nodiscard]] persistent_set insert(value_type&& value) const {
+    return persistent_set(tree_.insert(std::move(value)));
+  }
+
+  [[nodiscard]] persistent_set erase(const Key& key) const {
+    return persistent_set(tree_.erase(key));
+  }
+
+  // Версии совпадают, если у них общий корень (например, insert
+  // существующего ключа возвращает ту же версию)
+  bool shares_root(const persistent_set& other) const {
+    return tree_.sameVersion(other.tree_);
+  }
+
+  bool operator==(const persistent_set& other) const {
+    if (size() != other.size()) {
+      return false;
+    }
+    const Compare& comp = tree_.key_comp();
+    for (auto a = begin(), b = other.begin(); a != end(); ++a, ++b) {
+      if (comp(*a, *b) || comp(*b, *a)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool operator!=(const persistent_set& other) const {
+    return !(*this == other);
+  }
+
+ private:
+  explicit persistent_set(Tree tree) : tree_(std::move(tree)) {}
+
+  Tree tree_;
+};
+
+}  // namespace s21
+
+#endif  // S21_PERSISTENT_SET_H
@@ -1,36 +1,75 @@
 #ifndef S21_SET_H
 #define S21_SET_H
 
+#include <functional>
 #include <initializer_list>
+#include <iterator>
 #include <utility>
 
+#include "../BTree/s21_btree.h"
 #include "../RBtree/s21_rbtree.h"
 
 namespace s21 {
 
-template <typename Key>
+// Tree позволяет выбрать вариант дерева, например RBTree с порядковой
+// статистикой или BTree (см. order_statistic_set и btree_set ниже).
+// Операции, которых нет у выбранного дерева, недоступны.
+template <typename Key, typename Compare = std::less<Key>,
+          typename Tree = RBTree<Key, false, Compare>>
 class set {
+  // Используем RBTree без дубликатов
+  using SetTree = Tree;
+
  public:
   using key_type = Key;
   using value_type = Key;
   using reference = value_type&;
   using const_reference = const value_type&;
   using size_type = size_t;
+  using key_compare = Compare;
+  using value_compare = Compare;
+  using node_pool = typename SetTree::node_pool;
+  using node_type = typename SetTree::node_handle;
 
   class Iterator {
    public:
-    Iterator(typename RBTree<Key>::Node* node, const RBTree<Key>* tree)
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = Key;
+    using difference_type = std::ptrdiff_t;
+    using pointer = value_type*;
+    using reference = value_type&;
+
+    Iterator(typename SetTree::Node* node, const SetTree* tree)
         : node_(node), tree_(tree) {}
 
     reference operator*() const { return node_->data; }
 
     Iterator& operator++() {
       if (node_) {
-        node_ = tree_->successor(node_);
+        node_ = SetTree::successor(node_);
       }
       return *this;
     }
 
+    Iterator operator++(int) {
+      Iterator old = *this;
+      ++*this;
+      return old;
+    }
+
+    // Из end() переходит к последнему элементу, указатель на который
+    // хранится в дереве
+    Iterator& operator--() {
+      node_ = node_ ? SetTree::predecessor(node_) : tree_->last();
+      return *this;
+    }
+
+    Iterator operator--(int) {
+      Iterator old = *this;
+      --*this;
+      return old;
+    }
+
     bool operator==(const Iterator& other) const {
       return node_ == other.node_;
     }
@@ -40,24 +79,49 @@ class set {
     }
 
    private:
-    typename RBTree<Key>::Node* node_;
-    const RBTree<Key>* tree_;
+    friend class set;
+
+    typename SetTree::Node* node_;
+    const SetTree* tree_;
   };
 
   class ConstIterator {
    public:
-    ConstIterator(typename RBTree<Key>::Node* node, const RBTree<Key>* tree)
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = Key;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const value_type*;
+    using reference = const value_type&;
+
+    ConstIterator(typename SetTree::Node* node, const SetTree* tree)
         : node_(node), tree_(tree) {}
 
     const_reference operator*() const { return node_->data; }
 
     ConstIterator& operator++() {
       if (node_) {
-        node_ = tree_->successor(node_);
+        node_ = SetTree::successor(node_);
       }
       return *this;
     }
 
+    ConstIterator operator++(int) {
+      ConstIterator old = *this;
+      ++*this;
+      return old;
+    }
+
+    ConstIterator& operator--() {
+      node_ = node_ ? SetTree::predecessor(node_) : tree_->last();
+      return *this;
+    }
+
+    ConstIterator operator--(int) {
+      ConstIterator old = *this;
+      --*this;
+      return old;
+    }
+
     bool operator==(const ConstIterator& other) const {
       return node_ == other.node_;
     }
@@ -67,45 +131,69 @@ class set {
     }
 
    private:
-    typename RBTree<Key>::Node* node_;
-    const RBTree<Key>* tree_;
+    typename SetTree::Node* node_;
+    const SetTree* tree_;
   };
 
   using iterator = Iterator;
   using const_iterator = ConstIterator;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  // Результат вставки извлечённого узла: если ключ уже был, узел
+  // возвращается обратно в node
+  struct insert_return_type {
+    iterator position;
+    bool inserted;
+    node_type node;
+  };
 
   set() = default;
 
-  set(std::initializer_list<value_type> const& items) {
-    for (const auto& item : items) {
-      insert(item);
-    }
+  explicit set(const Compare& comp) : tree_(comp) {}
+
+  // Узлы берутся из пула, который можно разделить с другими контейнерами.
+  // Пул не потокобезопасен: контейнеры с общим пулом нельзя менять из
+  // разных потоков одновременно. Зато merge и вставка node_type между ними
+  // перевешивают узлы без выделения памяти.
+  explicit set(std::shared_ptr<node_pool> pool,
+               const Compare& comp = Compare())
+      : tree_(std::move(pool), comp) {}
+
+  set(std::initializer_list<value_type> const& items,
+      const Compare& comp = Compare())
+      : tree_(comp) {
+    tree_.insertRange(items.begin(), items.end());
   }
 
-  set(const set& other) {
-    for (const auto& item : other) {
-      insert(item);
-    }
+  // Отсортированный диапазон строится за O(n), иначе вставка по одному
+  template <typename InputIt, typename = typename std::iterator_traits<
+                                  InputIt>::iterator_category>
+  set(InputIt first, InputIt last, const Compare& comp = Compare())
+      : tree_(comp) {
+    tree_.insertRange(first, last);
   }
 
-  set(set&& other) : tree_(std::move(other.tree_)) { other.tree_ = SetTree(); }
+  // Копируется структура дерева целиком, без повторных вставок
+  set(const set& other) : tree_(other.tree_) {}
+
+  set(set&& other) : tree_(std::move(other.tree_)) {
+    other.tree_ = SetTree(tree_.key_comp());
+  }
 
   ~set() = default;
 
   set& operator=(set&& other) {
     if (this != &other) {
       tree_ = std::move(other.tree_);
-      other.tree_ = SetTree();
+      other.tree_ = SetTree(tree_.key_comp());
     }
     return *this;
   }
 
   set& operator=(const set& other) {
     if (this != &other) {
-      clear();
-      for (const auto& item : other) {
-        insert(item);
-      }
+      tree_ = other.tree_;
     }
     return *this;
   }
@@ -120,62 +208,242 @@ class set {
 
   void clear() { tree_.clear(); }
 
+  // Наименьший и наибольший элементы за O(1). Контейнер не должен быть
+  // пустым.
+  const_reference front() const { return tree_.first()->data; }
+  const_reference back() const { return tree_.last()->data; }
+
+  // Удаляют наименьший или наибольший элемент, на пустом контейнере
+  // ничего не делают. Вместе с front()/back() позволяют использовать
+  // контейнер как двустороннюю очередь с приоритетом.
+  void pop_min() { tree_.popFirst(); }
+  void pop_max() { tree_.popLast(); }
+
   std::pair<iterator, bool> insert(const value_type& value) {
-    bool inserted = !tree_.contains(value);
-    if (inserted) {
-      tree_.insert(value);
-    }
-    return std::make_pair(iterator(tree_.find(value), &tree_), inserted);
+    auto [node, inserted] = tree_.insert(value);
+    return std::make_pair(iterator(node, &tree_), inserted);
+  }
+
+  // Ключ перемещается в узел; если равный уже есть, value не меняется
+  std::pair<iterator, bool> insert(value_type&& value) {
+    auto [node, inserted] = tree_.insert(std::move(value));
+    return std::make_pair(iterator(node, &tree_), inserted);
+  }
+
+  // Ключ конструируется из args сразу в узле дерева
+  template <typename... Args>
+  std::pair<iterator, bool> emplace(Args&&... args) {
+    auto [node, inserted] = tree_.emplace(std::forward<Args>(args)...);
+    return std::make_pair(iterator(node, &tree_), inserted);
+  }
+
+  // Вставка с подсказкой: если value встаёт непосредственно перед hint,
+  // узел подвешивается рядом без спуска от корня. Для потока ключей по
+  // возрастанию достаточно передавать end(). Возвращает итератор на
+  // вставленный или, для set, уже имеющийся равный элемент.
+  iterator insert(iterator hint, const value_type& value) {
+    return iterator(tree_.insertHint(hint.node_, value).first, &tree_);
+  }
+
+  iterator insert(iterator hint, value_type&& value) {
+    return iterator(tree_.insertHint(hint.node_, std::move(value)).first,
+                    &tree_);
+  }
+
+  template <typename... Args>
+  iterator emplace_hint(iterator hint, Args&&... args) {
+    return iterator(
+        tree_.emplaceHint(hint.node_, std::forward<Args>(args)...).first,
+        &tree_);
   }
 
   iterator find(const Key& key) { return iterator(tree_.find(key), &tree_); }
 
-  void erase(iterator pos) {
-    if (pos != end()) {
-      tree_.erase(*pos);
+  // Гетерогенный поиск: доступен, если Compare::is_transparent определён
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  iterator find(const K& key) {
+    return iterator(tree_.find(key), &tree_);
+  }
+
+  // Удаляет именно тот элемент, на который указывает pos, без поиска по
+  // ключу, и возвращает итератор на следующий
+  iterator erase(iterator pos) {
+    if (pos == end()) {
+      return pos;
+    }
+    return iterator(tree_.eraseAt(pos.node_), &tree_);
+  }
+
+  // Удаляет [first, last) и возвращает итератор на элемент, который стоял
+  // на месте last
+  iterator erase(iterator first, iterator last) {
+    if (first == last) {
+      return last;
     }
+    return iterator(tree_.eraseRange(first.node_, last.node_), &tree_);
   }
 
-  bool contains(const Key& key) const { return tree_.find(key) != nullptr; }
+  bool contains(const Key& key) const { return tree_.contains(key); }
 
-  iterator begin() {
-    return iterator(tree_.minimum((tree_.getRoot())), &tree_);
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  bool contains(const K& key) const {
+    return tree_.contains(key);
   }
+
+  size_type count(const Key& key) const { return tree_.count(key); }
+
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  size_type count(const K& key) const {
+    return tree_.count(key);
+  }
+
+  std::pair<iterator, iterator> equal_range(const Key& key) {
+    auto [lower, upper] = tree_.equal_range(key);
+    return std::make_pair(iterator(lower, &tree_), iterator(upper, &tree_));
+  }
+
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  std::pair<iterator, iterator> equal_range(const K& key) {
+    auto [lower, upper] = tree_.equal_range(key);
+    return std::make_pair(iterator(lower, &tree_), iterator(upper, &tree_));
+  }
+
+  iterator lower_bound(const Key& key) {
+    return iterator(tree_.lower_bound(key), &tree_);
+  }
+
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  iterator lower_bound(const K& key) {
+    return iterator(tree_.lower_bound(key), &tree_);
+  }
+
+  iterator upper_bound(const Key& key) {
+    return iterator(tree_.upper_bound(key), &tree_);
+  }
+
+  template <typename K, typename C = Compare,
+            typename = typename C::is_transparent>
+  iterator upper_bound(const K& key) {
+    return iterator(tree_.upper_bound(key), &tree_);
+  }
+
+  // Порядковая статистика: доступна, если Tree хранит размеры поддеревьев.
+  // k-й по порядку элемент (с нуля) или end(), если k >= size()
+  iterator nth_element(size_type k) {
+    return iterator(tree_.select(k), &tree_);
+  }
+
+  // Количество элементов, строго меньших key
+  size_type rank(const Key& key) const { return tree_.rank(key); }
+
+  // Количество элементов в отрезке [lo, hi]
+  size_type count_range(const Key& lo, const Key& hi) const {
+    return tree_.count_range(lo, hi);
+  }
+
+  key_compare key_comp() const { return tree_.key_comp(); }
+
+  value_compare value_comp() const { return tree_.key_comp(); }
+
+  iterator begin() { return iterator(tree_.first(), &tree_); }
   iterator end() { return iterator(nullptr, &tree_); }
 
-  void merge(set& other) {
-    auto it = other.begin();
-    while (it != other.end()) {
-      auto next = it;
-      ++next;
-      if (!contains(*it)) {
-        insert(*it);
-        other.erase(it);
-      }
-      it = next;
-    }
+  // Переносит элементы, ключей которых здесь нет; равные остаются в other.
+  // Узлы перевешиваются без выделения памяти, только если контейнеры
+  // созданы над общим пулом, иначе элементы перемещаются в новые узлы
+  // (у BTree — всегда), и пулы контейнеров остаются независимыми.
+  void merge(set& other) { tree_.merge(other.tree_); }
+
+  // Извлекает элемент вместе с узлом; пустой handle для end()
+  node_type extract(iterator pos) {
+    return pos == end() ? node_type() : tree_.extract(pos.node_);
+  }
+
+  node_type extract(const Key& key) { return tree_.extract(key); }
+
+  // Узел из того же пула подвешивается как есть; из чужого пула ключ
+  // перемещается в новый узел, а сам узел возвращается в свой пул
+
+  insert_return_type insert(node_type&& node) {
+    auto [pos, inserted] = tree_.insert(std::move(node));
+    return {iterator(pos, &tree_), inserted, std::move(node)};
+  }
+
+  // Теоретико-множественные операции, результат записывается в *this.
+  // Работают за O(n + m), а при маленьком other — за O(m log n).
+  void union_with(const set& other) { tree_.unionWith(other.tree_); }
+
+  void intersect_with(const set& other) { tree_.intersectWith(other.tree_); }
+
+  void difference(const set& other) { tree_.differenceWith(other.tree_); }
+
+  void symmetric_difference(const set& other) {
+    tree_.symmetricDifferenceWith(other.tree_);
   }
 
+  // Оставляет в контейнере элементы меньше key, а остальные возвращает
+  // отдельным контейнером за O(log n + размер меньшей части). Меньшая часть
+  // получает собственный пул узлов, так что части не связаны друг с другом
+  // и могут использоваться из разных потоков.
+  set split_at(const Key& key) { return set(tree_.split(key)); }
+
+  // Переносит в конец контейнера все элементы other, которые должны быть
+  // строго больше всех элементов этого контейнера, за O(log n + log m).
+  // При пересечении диапазонов бросает std::invalid_argument.
+  void join(set& other) { tree_.join(other.tree_); }
+
   void swap(set& other) { std::swap(tree_, other.tree_); }
 
   const_iterator begin() const {
-    return const_iterator(tree_.minimum(tree_.getRoot()), &tree_);
+    return const_iterator(tree_.first(), &tree_);
   }
 
   const_iterator end() const { return const_iterator(nullptr, &tree_); }
 
+  // Обход с конца: rbegin() не спускается по дереву, каждый шаг — переход к
+  // предшественнику, так что k наибольших элементов читаются за O(k)
+  reverse_iterator rbegin() { return reverse_iterator(end()); }
+  const_reverse_iterator rbegin() const {
+    return const_reverse_iterator(end());
+  }
+
+  reverse_iterator rend() { return reverse_iterator(begin()); }
+  const_reverse_iterator rend() const {
+    return const_reverse_iterator(begin());
+  }
+
   template <typename... Args>
   std::vector<std::pair<iterator, bool>> insert_many(Args&&... args) {
     std::vector<std::pair<iterator, bool>> result;
-    (result.push_back(insert(std::forward<Args>(args))), ...);
+    (result.push_back(emplace(std::forward<Args>(args))), ...);
     return result;
   }
 
  private:
-  using SetTree = RBTree<Key, false>;  // Используем RBTree без дубликатов
+  explicit set(SetTree&& tree) : tree_(std::move(tree)) {}
+
   SetTree tree_;
 };
 
+template <typename Key, typename Compare = std::less<Key>>
+using order_statistic_set =
+    set<Key, Compare, RBTree<Key, false, Compare, true>>;
+
+// Узлы с цветом в бите указателя на родителя: меньше памяти на элемент
+template <typename Key, typename Compare = std::less<Key>>
+using compact_set =
+    set<Key, Compare, RBTree<Key, false, Compare, false, true>>;
+
+// B+-дерево вместо красно-черного: быстрее поиск и обход, но вставка и
+// удаление делают недействительными итераторы на соседние элементы
+template <typename Key, typename Compare = std::less<Key>>
+using btree_set = set<Key, Compare, BTree<Key, false, Compare>>;
+
 }  // namespace s21
 
 #endif  // S21_SET_H
\ No newline at end of file
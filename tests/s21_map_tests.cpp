@@ -1,8 +1,12 @@
 #include <gtest/gtest.h>
 
 #include <map>
+#include <random>
+#include <string>
+#include <string_view>
 
 #include "../map/s21_map.h"
+#include "../map/s21_persistent_map.h"
 
 TEST(MapTest, BasicConstructor) {
   s21::map<int, int> test;
@@ -502,4 +506,487 @@ TEST(MapTest, Insert_Many) {
     ++std_iter;
   }
   ASSERT_TRUE(my_iter == my_map.end());
-}
\ No newline at end of file
+}
+
+template <typename StdMap, typename MyMap>
+static bool sameContents(StdMap& std_map, MyMap& my_map) {
+  auto my_iter = my_map.begin();
+  for (const auto& item : std_map) {
+    if (my_iter == my_map.end() || (*my_iter).first != item.first ||
+        (*my_iter).second != item.second) {
+      return false;
+    }
+    ++my_iter;
+  }
+  return my_iter == my_map.end();
+}
+
+TEST(MapTest, MergeLeavesDuplicatesInSource) {
+  s21::map<int, std::string> my_map{{1, "a"}, {3, "c"}, {5, "e"}};
+  s21::map<int, std::string> my_map2{{2, "b"}, {3, "other"}, {6, "f"}};
+  std::map<int, std::string> std_map{{1, "a"}, {3, "c"}, {5, "e"}};
+  std::map<int, std::string> std_map2{{2, "b"}, {3, "other"}, {6, "f"}};
+
+  my_map.merge(my_map2);
+  std_map.merge(std_map2);
+
+  EXPECT_TRUE(sameContents(std_map, my_map));
+  EXPECT_EQ(my_map.size(), std_map.size());
+  ASSERT_EQ(my_map2.size(), 1U);
+  EXPECT_EQ(my_map2.at(3), "other");
+  EXPECT_EQ(my_map.at(3), "c");
+}
+
+TEST(MapTest, MergeManyNodes) {
+  s21::map<int, int> my_map;
+  s21::map<int, int> my_map2;
+  std::map<int, int> std_map;
+  std::map<int, int> std_map2;
+  for (int i = 0; i < 2000; ++i) {
+    my_map.insert(i * 3 % 1999, i);
+    std_map.insert({i * 3 % 1999, i});
+    my_map2.insert(i * 7 % 2503, -i);
+    std_map2.insert({i * 7 % 2503, -i});
+  }
+  my_map.merge(my_map2);
+  std_map.merge(std_map2);
+  EXPECT_TRUE(sameContents(std_map, my_map));
+  EXPECT_TRUE(sameContents(std_map2, my_map2));
+  EXPECT_EQ(my_map.size(), std_map.size());
+  EXPECT_EQ(my_map2.size(), std_map2.size());
+}
+
+TEST(MapTest, ExtractAndInsertNode) {
+  s21::map<int, std::string> source{{1, "one"}, {2, "two"}, {3, "three"}};
+  s21::map<int, std::string> target{{3, "drei"}};
+
+  auto node = source.extract(2);
+  ASSERT_FALSE(node.empty());
+  EXPECT_EQ(node.key(), 2);
+  EXPECT_EQ(node.mapped(), "two");
+  EXPECT_FALSE(source.contains(2));
+  EXPECT_EQ(source.size(), 2U);
+
+  node.key() = 20;
+  auto result = target.insert(std::move(node));
+  EXPECT_TRUE(result.inserted);
+  EXPECT_TRUE(result.node.empty());
+  EXPECT_EQ((*result.position).first, 20);
+  EXPECT_EQ(target.at(20), "two");
+
+  // The key is taken: the node comes back in the result
+  auto duplicate = target.insert(source.extract(source.find(3)));
+  EXPECT_FALSE(duplicate.inserted);
+  ASSERT_TRUE(static_cast<bool>(duplicate.node));
+  EXPECT_EQ(duplicate.node.mapped(), "three");
+  EXPECT_EQ((*duplicate.position).second, "drei");
+
+  EXPECT_TRUE(source.extract(42).empty());
+  EXPECT_TRUE(source.extract(source.end()).empty());
+  EXPECT_FALSE(target.insert(s21::map<int, std::string>::node_type())
+                   .inserted);
+  EXPECT_EQ(source.size(), 1U);
+  EXPECT_EQ(target.size(), 2U);
+}
+
+TEST(MapTest, SizeTracksEveryModifier) {
+  s21::map<int, int> my_map;
+  std::map<int, int> std_map;
+  std::mt19937 gen(11);
+  for (int i = 0; i < 5000; ++i) {
+    int key = static_cast<int>(gen() % 700);
+    switch (gen() % 5) {
+      case 0:
+        EXPECT_EQ(my_map.insert(key, i).second,
+                  std_map.insert({key, i}).second);
+        break;
+      case 1:
+        my_map.insert_or_assign(key, i);
+        std_map.insert_or_assign(key, i);
+        break;
+      case 2:
+        my_map[key] = i;
+        std_map[key] = i;
+        break;
+      case 3:
+        if (my_map.contains(key)) {
+          my_map.erase(my_map.find(key));
+          std_map.erase(key);
+        }
+        break;
+      default:
+        my_map.extract(key);
+        std_map.extract(key);
+    }
+    ASSERT_EQ(my_map.size(), std_map.size());
+  }
+  EXPECT_TRUE(sameContents(std_map, my_map));
+
+  s21::map<int, int> copy(my_map);
+  s21::map<int, int> other{{-1, 1}, {-2, 2}};
+  EXPECT_EQ(copy.size(), my_map.size());
+  copy.swap(other);
+  EXPECT_EQ(copy.size(), 2U);
+  EXPECT_EQ(other.size(), my_map.size());
+  s21::map<int, int> moved(std::move(other));
+  EXPECT_EQ(moved.size(), my_map.size());
+  EXPECT_EQ(other.size(), 0U);
+  other = std::move(moved);
+  EXPECT_EQ(other.size(), my_map.size());
+  EXPECT_EQ(moved.size(), 0U);
+  other.clear();
+  EXPECT_EQ(other.size(), 0U);
+  EXPECT_TRUE(other.empty());
+}
+
+// Rotations relink nodes, so an element stays in its node for as long as
+// it is in the map
+TEST(MapTest, IteratorsSurviveRebalancing) {
+  s21::map<int, std::string> my_map;
+  using Iterator = decltype(my_map.begin());
+  std::vector<Iterator> iterators;
+  std::vector<const std::string*> values;
+  // Ascending keys rotate at almost every insertion
+  for (int i = 0; i < 3000; ++i) {
+    Iterator it = my_map.insert(i, std::to_string(i)).first;
+    iterators.push_back(it);
+    values.push_back(&(*it).second);
+  }
+  for (int i = 0; i < 3000; ++i) {
+    ASSERT_EQ((*iterators[i]).first, i);
+    ASSERT_EQ(&(*iterators[i]).second, values[i]);
+  }
+
+  for (int i = 0; i < 3000; i += 3) {
+    my_map.erase(iterators[i]);
+  }
+  for (int i = 0; i < 3000; ++i) {
+    if (i % 3 != 0) {
+      ASSERT_EQ((*iterators[i]).first, i);
+      ASSERT_EQ(&(*iterators[i]).second, values[i]);
+      ASSERT_EQ(my_map.find(i), iterators[i]);
+    }
+  }
+  EXPECT_EQ(my_map.size(), 2000U);
+  int expected = 1;
+  for (auto it = my_map.begin(); it != my_map.end(); ++it) {
+    ASSERT_EQ((*it).first, expected);
+    expected += expected % 3 == 1 ? 1 : 2;
+  }
+}
+
+// Checks the AVL invariant and stored heights; returns the height
+template <typename Ptr>
+static int checkedHeight(const Ptr& node) {
+  if (node == nullptr) {
+    return 0;
+  }
+  int left = checkedHeight(node->left);
+  int right = checkedHeight(node->right);
+  EXPECT_LE(std::abs(left - right), 1);
+  EXPECT_EQ(node->height, std::max(left, right) + 1);
+  return std::max(left, right) + 1;
+}
+
+TEST(PersistentMapTest, VersionsAreIndependent) {
+  s21::persistent_map<int, std::string> empty;
+  auto v1 = empty.insert(1, "one").insert(2, "two");
+  auto v2 = v1.insert_or_assign(2, "deux");
+  auto v3 = v2.erase(1);
+
+  EXPECT_TRUE(empty.empty());
+  EXPECT_EQ(v1.at(2), "two");
+  EXPECT_EQ(v2.at(2), "deux");
+  EXPECT_EQ(v2.size(), 2U);
+  EXPECT_FALSE(v3.contains(1));
+  EXPECT_TRUE(v2.contains(1));
+  EXPECT_EQ(v3.size(), 1U);
+  EXPECT_THROW(v3.at(1), std::out_of_range);
+  EXPECT_EQ(v1.find(5), nullptr);
+
+  // Nothing changes: the same version comes back
+  EXPECT_TRUE(v1.insert(1, "uno").shares_root(v1));
+  EXPECT_TRUE(v1.erase(7).shares_root(v1));
+  EXPECT_EQ(v1.insert(1, "uno").at(1), "one");
+}
+
+// A comparator with state: the order comes from the object, not the type
+struct DirectedLess {
+  bool descending;
+  bool operator()(int lhs, int rhs) const {
+    return descending ? rhs < lhs : lhs < rhs;
+  }
+};
+
+TEST(PersistentMapTest, UsesStoredComparator) {
+  s21::persistent_map<int, int, DirectedLess> empty(DirectedLess{true});
+  auto v1 = empty.insert(1, 10).insert(3, 30).insert(2, 20);
+  auto v2 = v1.insert_or_assign(3, 33).erase(1);
+  EXPECT_TRUE(v1.key_comp().descending);
+  std::vector<std::pair<const int, int>> order{{3, 30}, {2, 20}, {1, 10}};
+  EXPECT_TRUE(std::equal(v1.begin(), v1.end(), order.begin(), order.end()));
+  EXPECT_EQ(v2.size(), 2U);
+  EXPECT_EQ(v2.at(3), 33);
+  EXPECT_FALSE(v2.contains(1));
+  EXPECT_EQ((*v2.begin()).first, 3);
+}
+
+TEST(PersistentMapTest, RandomHistoryMatchesStdMap) {
+  std::mt19937 gen(23);
+  std::vector<s21::PersistentAVLTree<int, int>> versions(1);
+  std::vector<std::map<int, int>> expected(1);
+  for (int i = 0; i < 3000; ++i) {
+    size_t base = gen() % versions.size();
+    int key = static_cast<int>(gen() % 500);
+    auto reference = expected[base];
+    if (gen() % 3 == 0) {
+      versions.push_back(versions[base].erase(key));
+      reference.erase(key);
+    } else {
+      versions.push_back(versions[base].insert_or_assign(key, i));
+      reference[key] = i;
+    }
+    expected.push_back(reference);
+  }
+  // Every version, old or new, still holds exactly its own contents
+  for (size_t v = 0; v < versions.size(); v += 37) {
+    ASSERT_EQ(versions[v].size(), expected[v].size());
+    EXPECT_TRUE(std::equal(versions[v].begin(), versions[v].end(),
+                           expected[v].begin(), expected[v].end()));
+    checkedHeight(versions[v].getRoot());
+  }
+}
+
+// Exposes the root to check the tree shape after relinking rotations
+class MapProbe : public s21::map<int, int> {
+ public:
+  int checkedShape() const { return checkParents(root, nullptr); }
+
+ private:
+  static int checkParents(const Node* node, const Node* parent) {
+    if (node == nullptr) {
+      return 0;
+    }
+    EXPECT_EQ(node->parent, parent);
+    int left = checkParents(node->left, node);
+    int right = checkParents(node->right, node);
+    EXPECT_LE(std::abs(left - right), 1);
+    EXPECT_EQ(node->height, std::max(left, right) + 1);
+    return std::max(left, right) + 1;
+  }
+};
+
+TEST(MapTest, RandomOperationsKeepTreeShape) {
+  MapProbe my_map;
+  std::map<int, int> std_map;
+  std::mt19937 gen(5);
+  for (int i = 0; i < 20000; ++i) {
+    int key = static_cast<int>(gen() % 2000);
+    if (gen() % 3 == 0) {
+      auto it = my_map.find(key);
+      if (it != my_map.end()) {
+        my_map.erase(it);
+      }
+      std_map.erase(key);
+    } else {
+      my_map.insert(key, i);
+      std_map.insert({key, i});
+    }
+    if (i % 1000 == 0) {
+      my_map.checkedShape();
+    }
+  }
+  my_map.checkedShape();
+  EXPECT_TRUE(sameContents(std_map, my_map));
+  MapProbe copy(my_map);
+  EXPECT_EQ(copy.checkedShape(), my_map.checkedShape());
+}
+
+// Key that counts the comparisons made by the tree
+struct CountedKey {
+  int value;
+  static inline int comparisons = 0;
+
+  bool operator<(const CountedKey& other) const {
+    ++comparisons;
+    return value < other.value;
+  }
+  bool operator>(const CountedKey& other) const {
+    ++comparisons;
+    return value > other.value;
+  }
+  bool operator==(const CountedKey& other) const {
+    ++comparisons;
+    return value == other.value;
+  }
+};
+
+TEST(MapTest, InsertDescendsOnce) {
+  s21::map<CountedKey, int> my_map;
+  for (int i = 0; i < 1000; ++i) {
+    my_map.insert(CountedKey{i * 7919 % 1000}, i);
+  }
+  // An AVL tree of 1000 nodes is at most 14 levels deep, and one descent
+  // makes at most two comparisons per level
+  CountedKey::comparisons = 0;
+  auto [it, inserted] = my_map.insert(CountedKey{1000}, 1);
+  EXPECT_TRUE(inserted);
+  EXPECT_LE(CountedKey::comparisons, 2 * 14);
+  EXPECT_EQ((*it).first.value, 1000);
+
+  CountedKey::comparisons = 0;
+  auto [same, again] = my_map.insert(CountedKey{500}, 2);
+  EXPECT_FALSE(again);
+  EXPECT_LE(CountedKey::comparisons, 2 * 14);
+  EXPECT_EQ((*same).first.value, 500);
+
+  CountedKey::comparisons = 0;
+  my_map[CountedKey{-1}] = 5;
+  EXPECT_LE(CountedKey::comparisons, 2 * 14);
+  EXPECT_EQ(my_map.size(), 1002U);
+}
+
+// Mapped type that counts how it was created
+struct Tracked {
+  static inline int copies = 0;
+  static inline int moves = 0;
+  std::string text;
+
+  Tracked() = default;
+  explicit Tracked(std::string value) : text(std::move(value)) {}
+  Tracked(const Tracked& other) : text(other.text) { ++copies; }
+  Tracked(Tracked&& other) noexcept : text(std::move(other.text)) {
+    ++moves;
+  }
+  Tracked& operator=(const Tracked& other) {
+    text = other.text;
+    ++copies;
+    return *this;
+  }
+  Tracked& operator=(Tracked&& other) noexcept {
+    text = std::move(other.text);
+    ++moves;
+    return *this;
+  }
+
+  static void reset() { copies = moves = 0; }
+};
+
+TEST(MapTest, InsertOrAssignKeepsNode) {
+  s21::map<int, Tracked> my_map;
+  auto [first, added] = my_map.insert_or_assign(1, Tracked("one"));
+  EXPECT_TRUE(added);
+  const Tracked* address = &(*first).second;
+
+  Tracked::reset();
+  auto [second, again] = my_map.insert_or_assign(1, Tracked("uno"));
+  EXPECT_FALSE(again);
+  EXPECT_EQ(second, first);
+  EXPECT_EQ(&(*second).second, address);
+  EXPECT_EQ(address->text, "uno");
+  EXPECT_EQ(Tracked::copies, 0);
+  EXPECT_EQ(Tracked::moves, 1);
+
+  Tracked value("eins");
+  my_map.insert_or_assign(1, value);
+  EXPECT_EQ(Tracked::copies, 1);
+  EXPECT_EQ(my_map.at(1).text, "eins");
+  EXPECT_EQ(my_map.size(), 1U);
+}
+
+TEST(MapTest, TryEmplaceAndEmplaceConstructInPlace) {
+  s21::map<int, Tracked> my_map;
+  Tracked::reset();
+  auto [it, inserted] = my_map.try_emplace(5, "five");
+  EXPECT_TRUE(inserted);
+  EXPECT_EQ((*it).second.text, "five");
+  auto [emplaced, ok] = my_map.emplace(7, "seven");
+  EXPECT_TRUE(ok);
+  EXPECT_EQ((*emplaced).second.text, "seven");
+  EXPECT_EQ(Tracked::copies, 0);
+  EXPECT_EQ(Tracked::moves, 0);
+
+  // The key is taken: the argument is not moved from
+  std::string text = "cinq";
+  auto [same, again] = my_map.try_emplace(5, std::move(text));
+  EXPECT_FALSE(again);
+  EXPECT_EQ(same, it);
+  EXPECT_EQ(text, "cinq");
+  EXPECT_FALSE(my_map.emplace(7, "sieben").second);
+  EXPECT_EQ(my_map.at(7).text, "seven");
+
+  // operator[] on an existing key touches nothing
+  my_map[5].text += "!";
+  EXPECT_EQ(Tracked::copies, 0);
+  EXPECT_EQ(Tracked::moves, 0);
+  EXPECT_EQ(my_map.at(5).text, "five!");
+  EXPECT_TRUE(my_map[9].text.empty());
+  EXPECT_EQ(my_map.size(), 3U);
+}
+
+TEST(MapTest, CustomComparatorOrder) {
+  s21::map<int, int, std::greater<int>> my_map{{1, 10}, {3, 30}, {2, 20}};
+  std::map<int, int, std::greater<int>> std_map{{1, 10}, {3, 30}, {2, 20}};
+  EXPECT_TRUE(sameContents(std_map, my_map));
+  EXPECT_EQ((*my_map.lower_bound(4)).first, 3);
+  EXPECT_EQ((*my_map.upper_bound(3)).first, 2);
+  EXPECT_EQ(my_map.upper_bound(1), my_map.end());
+  EXPECT_EQ(my_map.count(2), 1U);
+  EXPECT_EQ(my_map.count(5), 0U);
+}
+
+TEST(MapTest, BoundsMatchStdMap) {
+  s21::map<int, int> my_map;
+  std::map<int, int> std_map;
+  for (int i = 0; i < 500; ++i) {
+    my_map.insert(i * 4 % 1003, i);
+    std_map.insert({i * 4 % 1003, i});
+  }
+  for (int key = -2; key < 1010; ++key) {
+    auto lower = std_map.lower_bound(key);
+    auto upper = std_map.upper_bound(key);
+    auto my_lower = my_map.lower_bound(key);
+    auto my_upper = my_map.upper_bound(key);
+    ASSERT_EQ(lower == std_map.end(), my_lower == my_map.end());
+    ASSERT_EQ(upper == std_map.end(), my_upper == my_map.end());
+    if (lower != std_map.end()) {
+      ASSERT_EQ((*my_lower).first, lower->first);
+    }
+    if (upper != std_map.end()) {
+      ASSERT_EQ((*my_upper).first, upper->first);
+    }
+    ASSERT_EQ(my_map.count(key), std_map.count(key));
+  }
+}
+
+TEST(MapTest, TransparentLookup) {
+  s21::map<std::string, int, std::less<>> my_map{
+      {"alpha", 1}, {"beta", 2}, {"gamma", 3}};
+  std::string_view view = "beta";
+  EXPECT_EQ((*my_map.find(view)).second, 2);
+  EXPECT_EQ(my_map.find("delta"), my_map.end());
+  EXPECT_TRUE(my_map.contains(view));
+  EXPECT_FALSE(my_map.contains("delta"));
+  EXPECT_EQ(my_map.at("gamma"), 3);
+  EXPECT_THROW(my_map.at(std::string_view("zeta")), std::out_of_range);
+  EXPECT_EQ(my_map.count("alpha"), 1U);
+  EXPECT_EQ((*my_map.lower_bound("b")).first, "beta");
+  EXPECT_EQ((*my_map.upper_bound(view)).first, "gamma");
+  my_map.at(view) = 20;
+  EXPECT_EQ(my_map[std::string("beta")], 20);
+}
+
+TEST(MapTest, LookupComparesThreeWayPerLevel) {
+  s21::map<CountedKey, int> my_map;
+  for (int i = 0; i < 1000; ++i) {
+    my_map.insert(CountedKey{i}, i);
+  }
+  // Ascending inserts give a tree of at most 14 levels, and a three-way
+  // comparison takes two calls to operator<
+  CountedKey::comparisons = 0;
+  EXPECT_TRUE(my_map.contains(CountedKey{777}));
+  EXPECT_LE(CountedKey::comparisons, 2 * 14);
+  CountedKey::comparisons = 0;
+  EXPECT_EQ(my_map.find(CountedKey{5000}), my_map.end());
+  EXPECT_LE(CountedKey::comparisons, 2 * 14);
+}
@@ -0,0 +1,256 @@
+#include "tests.h"
+using namespace s21;
+
+// Собирает элементы дерева в порядке обхода
+template <typename Tree>
+static auto toVector(const Tree& tree) {
+  std::vector<std::decay_t<decltype(tree.first()->data)>> result;
+  for (auto node = tree.first(); node; node = tree.successor(node)) {
+    result.push_back(node->data);
+  }
+  return result;
+}
+
+TEST(BTreeTest, EmptyTree) {
+  BTree<int> tree;
+  EXPECT_TRUE(tree.empty());
+  EXPECT_EQ(tree.first(), nullptr);
+  EXPECT_EQ(tree.find(1), nullptr);
+  EXPECT_EQ(tree.lower_bound(1), nullptr);
+  tree.erase(1);
+  EXPECT_EQ(tree.size(), 0);
+}
+
+TEST(BTreeTest, InsertReturnsNodeAndFlag) {
+  BTree<int> tree;
+  auto [node, inserted] = tree.insert(5);
+  EXPECT_TRUE(inserted);
+  EXPECT_EQ(node->data, 5);
+  auto [same, again] = tree.insert(5);
+  EXPECT_FALSE(again);
+  EXPECT_EQ(same, node);
+  EXPECT_EQ(tree.size(), 1);
+}
+
+TEST(BTreeTest, RandomOperationsMatchStdSet) {
+  BTree<int> tree;
+  std::set<int> reference;
+  std::mt19937 gen(3);
+  for (int i = 0; i < 200000; ++i) {
+    int key = static_cast<int>(gen() % 50000);
+    if (gen() % 3 == 0) {
+      tree.erase(key);
+      reference.erase(key);
+    } else {
+      auto [node, inserted] = tree.insert(key);
+      EXPECT_EQ(inserted, reference.insert(key).second);
+      EXPECT_EQ(node->data, key);
+    }
+  }
+  ASSERT_EQ(tree.size(), reference.size());
+  EXPECT_EQ(toVector(tree),
+            std::vector<int>(reference.begin(), reference.end()));
+  for (int key = -1; key <= 50000; key += 7) {
+    auto lower = reference.lower_bound(key);
+    const auto* node = tree.lower_bound(key);
+    if (lower == reference.end()) {
+      EXPECT_EQ(node, nullptr);
+    } else {
+      ASSERT_NE(node, nullptr);
+      EXPECT_EQ(node->data, *lower);
+    }
+    EXPECT_EQ(tree.contains(key), reference.count(key) == 1);
+  }
+}
+
+TEST(BTreeTest, EraseEverythingReleasesNodes) {
+  BTree<uint64_t> tree;
+  std::vector<uint64_t> keys(100000);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    keys[i] = i * 2654435761u % 1000003;
+    tree.insert(keys[i]);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(5));
+  for (size_t i = 0; i < keys.size(); ++i) {
+    tree.erase(keys[i]);
+    if (i % 9973 == 0) {
+      EXPECT_EQ(tree.size(), keys.size() - i - 1);
+      auto rest = toVector(tree);
+      EXPECT_TRUE(std::is_sorted(rest.begin(), rest.end()));
+    }
+  }
+  EXPECT_TRUE(tree.empty());
+  EXPECT_EQ(tree.first(), nullptr);
+  EXPECT_EQ(tree.pool()->in_use(), 0);
+}
+
+TEST(BTreeMultisetTest, DuplicatesAcrossLeaves) {
+  BTree<int, true> tree;
+  std::multiset<int> reference;
+  for (int i = 0; i < 3000; ++i) {
+    tree.insert(i % 7);
+    reference.insert(i % 7);
+  }
+  EXPECT_EQ(tree.count(3), reference.count(3));
+  auto [first, last] = tree.equal_range(3);
+  size_t cnt = 0;
+  for (auto node = first; node != last; node = tree.successor(node)) {
+    EXPECT_EQ(node->data, 3);
+    cnt++;
+  }
+  EXPECT_EQ(cnt, reference.count(3));
+  for (int i = 0; i < 400; ++i) {
+    tree.erase(3);
+  }
+  EXPECT_EQ(tree.count(3), reference.count(3) - 400);
+  EXPECT_EQ(tree.find(4), tree.lower_bound(4));
+  EXPECT_EQ(tree.size(), 2600);
+}
+
+TEST(BTreeTest, StringKeys) {
+  BTree<std::string> tree;
+  std::set<std::string> reference;
+  std::mt19937 gen(9);
+  for (int i = 0; i < 20000; ++i) {
+    std::string key = "key-" + std::to_string(gen() % 5000) +
+                      std::string(gen() % 40, 'x');
+    if (gen() % 4 == 0) {
+      tree.erase(key);
+      reference.erase(key);
+    } else {
+      tree.insert(key);
+      reference.insert(key);
+    }
+  }
+  EXPECT_EQ(toVector(tree),
+            std::vector<std::string>(reference.begin(), reference.end()));
+
+  BTree<std::string> copy(tree);
+  EXPECT_EQ(toVector(copy), toVector(tree));
+  copy.clear();
+  EXPECT_TRUE(copy.empty());
+  EXPECT_EQ(tree.size(), reference.size());
+}
+
+TEST(BTreeTest, SortedBuildAndCopy) {
+  std::vector<int> sorted(100000);
+  for (size_t i = 0; i < sorted.size(); ++i) {
+    sorted[i] = static_cast<int>(i * 3);
+  }
+  BTree<int> tree;
+  tree.insertRange(sorted.begin(), sorted.end());
+  EXPECT_EQ(tree.size(), sorted.size());
+  EXPECT_EQ(toVector(tree), sorted);
+
+  BTree<int> copy;
+  copy = tree;
+  EXPECT_EQ(toVector(copy), sorted);
+  for (int key = 0; key < 300000; key += 6) {
+    copy.erase(key);
+  }
+  EXPECT_EQ(copy.size(), 50000);
+  EXPECT_EQ(copy.find(3)->data, 3);
+  EXPECT_EQ(copy.find(6), nullptr);
+  EXPECT_EQ(tree.size(), sorted.size());
+}
+
+TEST(BTreeTest, AscendingAndDescendingInsert) {
+  BTree<int> ascending;
+  BTree<int> descending;
+  for (int i = 0; i < 50000; ++i) {
+    ascending.insert(i);
+    descending.insert(49999 - i);
+  }
+  EXPECT_EQ(toVector(ascending), toVector(descending));
+  // Вставка по возрастанию заполняет листья плотнее, чем деление пополам
+  EXPECT_LT(ascending.pool()->capacity_bytes(),
+            descending.pool()->capacity_bytes());
+}
+
+TEST(BTreeMultisetTest, BackwardTraversal) {
+  BTree<int, true> tree;
+  std::multiset<int> reference;
+  std::mt19937 gen(17);
+  for (int i = 0; i < 20000; ++i) {
+    int key = static_cast<int>(gen() % 2000);
+    if (gen() % 4 == 0) {
+      tree.erase(key);
+      auto it = reference.find(key);
+      if (it != reference.end()) reference.erase(it);
+    } else {
+      tree.insert(key);
+      reference.insert(key);
+    }
+  }
+  ASSERT_EQ(tree.last()->data, *reference.rbegin());
+  std::vector<int> backwards;
+  for (auto node = tree.last(); node; node = tree.predecessor(node)) {
+    backwards.push_back(node->data);
+  }
+  EXPECT_EQ(backwards, std::vector<int>(reference.rbegin(), reference.rend()));
+}
+
+TEST(BTreeMultisetTest, PopFirstAndLast) {
+  BTree<int, true> tree;
+  std::multiset<int> reference;
+  std::mt19937 gen(29);
+  for (int i = 0; i < 30000; ++i) {
+    int key = static_cast<int>(gen() % 3000);
+    tree.insert(key);
+    reference.insert(key);
+  }
+  while (!reference.empty()) {
+    ASSERT_EQ(tree.first()->data, *reference.begin());
+    ASSERT_EQ(tree.last()->data, *reference.rbegin());
+    if (gen() % 2) {
+      tree.popFirst();
+      reference.erase(reference.begin());
+    } else {
+      tree.popLast();
+      reference.erase(std::prev(reference.end()));
+    }
+  }
+  EXPECT_TRUE(tree.empty());
+  EXPECT_EQ(tree.first(), nullptr);
+  EXPECT_EQ(tree.pool()->in_use(), 0);
+  tree.popFirst();
+  tree.popLast();
+  EXPECT_EQ(tree.size(), 0);
+}
+
+TEST(BTreeMultisetTest, EraseAtRemovesExactSlot) {
+  BTree<int, true> tree;
+  std::vector<int> reference;
+  for (int i = 0; i < 5000; ++i) {
+    tree.insert(i % 50);
+  }
+  for (auto node = tree.first(); node; node = tree.successor(node)) {
+    reference.push_back(node->data);
+  }
+  std::mt19937 gen(41);
+  while (!reference.empty()) {
+    size_t index = gen() % reference.size();
+    auto node = tree.first();
+    for (size_t i = 0; i < index; ++i) {
+      node = tree.successor(node);
+    }
+    auto next = tree.eraseAt(node);
+    reference.erase(reference.begin() + static_cast<long>(index));
+    if (index == reference.size()) {
+      ASSERT_EQ(next, nullptr);
+    } else {
+      ASSERT_NE(next, nullptr);
+      ASSERT_EQ(next->data, reference[index]);
+      // Следующий элемент стоит на той же позиции в порядке обхода
+      auto check = tree.first();
+      for (size_t i = 0; i < index; ++i) {
+        check = tree.successor(check);
+      }
+      ASSERT_EQ(next, check);
+    }
+    if (reference.size() % 500 == 0) {
+      ASSERT_EQ(toVector(tree), reference);
+    }
+  }
+  EXPECT_EQ(tree.pool()->in_use(), 0);
+}
@@ -576,3 +576,399 @@ TEST(MultisetTest, InsertManyMixed) {
   EXPECT_TRUE(s.contains("banana"));
   EXPECT_TRUE(s.contains("cherry"));
 }
+
+// Тест общего пула узлов
+TEST(MultisetTest, SharedPool) {
+  auto pool = std::make_shared<multiset<int>::node_pool>();
+  multiset<int> ms1(pool);
+  multiset<int> ms2(pool);
+  ms1.insert_many(1, 1, 2);
+  ms2.insert_many(1, 3);
+  EXPECT_EQ(pool->in_use(), 5);
+
+  ms2.clear();
+  EXPECT_EQ(pool->in_use(), 3);
+  EXPECT_EQ(ms1.count(1), 2);
+}
+
+// Тест: insert возвращает итератор на только что вставленный элемент
+TEST(MultisetTest, InsertReturnsInsertedElement) {
+  multiset<int> ms{1, 2, 3};
+  auto it = ms.insert(2);
+  EXPECT_EQ(*it, 2);
+  ++it;
+  EXPECT_EQ(*it, 3);
+  EXPECT_EQ(ms.count(2), 2);
+}
+
+// Тест пользовательского компаратора
+TEST(MultisetTest, CustomCompare) {
+  multiset<int, std::greater<int>> ms{1, 3, 3, 2};
+  std::vector<int> order;
+  for (int value : ms) {
+    order.push_back(value);
+  }
+  EXPECT_EQ(order, (std::vector<int>{3, 3, 2, 1}));
+  EXPECT_EQ(ms.count(3), 2);
+  EXPECT_EQ(*ms.lower_bound(2), 2);
+  EXPECT_EQ(*ms.upper_bound(3), 2);
+}
+
+// Тест гетерогенного поиска
+TEST(MultisetTest, TransparentLookup) {
+  multiset<std::string, std::less<>> ms{"a", "b", "b", "c"};
+  std::string_view key = "b";
+  EXPECT_EQ(ms.count(key), 2);
+  EXPECT_TRUE(ms.contains(key));
+  EXPECT_EQ(*ms.find(key), "b");
+  EXPECT_EQ(*ms.lower_bound(std::string_view("bb")), "c");
+  EXPECT_TRUE(ms.find(std::string_view("d")) == ms.end());
+}
+
+// Сравнение границ и count со std::multiset на случайных данных
+TEST(MultisetTest, BoundsMatchStd) {
+  multiset<int> ms;
+  std::multiset<int> std_ms;
+  std::mt19937 gen(11);
+  for (int i = 0; i < 3000; ++i) {
+    int key = static_cast<int>(gen() % 300);
+    ms.insert(key);
+    std_ms.insert(key);
+  }
+  for (int key = -1; key <= 301; ++key) {
+    auto lower = ms.lower_bound(key);
+    auto std_lower = std_ms.lower_bound(key);
+    ASSERT_EQ(lower == ms.end(), std_lower == std_ms.end());
+    if (lower != ms.end()) {
+      EXPECT_EQ(*lower, *std_lower);
+    }
+
+    auto upper = ms.upper_bound(key);
+    auto std_upper = std_ms.upper_bound(key);
+    ASSERT_EQ(upper == ms.end(), std_upper == std_ms.end());
+    if (upper != ms.end()) {
+      EXPECT_EQ(*upper, *std_upper);
+    }
+
+    auto range = ms.equal_range(key);
+    EXPECT_TRUE(range.first == lower);
+    EXPECT_TRUE(range.second == upper);
+    EXPECT_EQ(ms.count(key), std_ms.count(key));
+  }
+}
+
+// Тест порядковой статистики: перцентили задержек
+TEST(MultisetTest, OrderStatistic) {
+  order_statistic_multiset<int> latencies;
+  for (int i = 1; i <= 100; ++i) {
+    latencies.insert(i % 10 == 0 ? 1000 : i);
+  }
+  EXPECT_EQ(*latencies.nth_element(0), 1);
+  // 95-й перцентиль попадает в выбросы
+  EXPECT_EQ(*latencies.nth_element(95), 1000);
+  EXPECT_EQ(latencies.rank(1000), 90);
+  EXPECT_EQ(latencies.count(1000), 10);
+  EXPECT_EQ(latencies.count_range(1, 9), 9);
+}
+
+// Тест конструктора от диапазона
+TEST(MultisetTest, RangeConstructor) {
+  std::vector<int> sorted{1, 1, 2, 3, 3, 3};
+  multiset<int> ms(sorted.begin(), sorted.end());
+  EXPECT_EQ(ms.size(), 6);
+  EXPECT_EQ(ms.count(3), 3);
+
+  multiset<int> copy(ms);
+  multiset<int> assigned;
+  assigned = ms;
+  std::vector<int> order(assigned.begin(), assigned.end());
+  EXPECT_EQ(order, sorted);
+  EXPECT_EQ(copy.count(1), 2);
+}
+
+// Тест операций над мультимножествами: кратности как в std::set_*
+TEST(MultisetTest, SetAlgebraMatchesStd) {
+  multiset<int> a{1, 1, 1, 2, 3, 3, 5};
+  multiset<int> b{1, 3, 3, 3, 4, 5, 5};
+  std::vector<int> va(a.begin(), a.end());
+  std::vector<int> vb(b.begin(), b.end());
+  std::vector<int> expected;
+
+  multiset<int> u(a);
+  u.union_with(b);
+  std::set_union(va.begin(), va.end(), vb.begin(), vb.end(),
+                 std::back_inserter(expected));
+  EXPECT_EQ(std::vector<int>(u.begin(), u.end()), expected);
+
+  expected.clear();
+  multiset<int> i(a);
+  i.intersect_with(b);
+  std::set_intersection(va.begin(), va.end(), vb.begin(), vb.end(),
+                        std::back_inserter(expected));
+  EXPECT_EQ(std::vector<int>(i.begin(), i.end()), expected);
+
+  expected.clear();
+  multiset<int> d(a);
+  d.difference(b);
+  std::set_difference(va.begin(), va.end(), vb.begin(), vb.end(),
+                      std::back_inserter(expected));
+  EXPECT_EQ(std::vector<int>(d.begin(), d.end()), expected);
+
+  expected.clear();
+  multiset<int> sd(a);
+  sd.symmetric_difference(b);
+  std::set_symmetric_difference(va.begin(), va.end(), vb.begin(), vb.end(),
+                                std::back_inserter(expected));
+  EXPECT_EQ(std::vector<int>(sd.begin(), sd.end()), expected);
+  EXPECT_EQ(sd.count(1), 2);
+}
+
+// Разность с маленьким мультимножеством удаляет по одному вхождению
+TEST(MultisetTest, DifferenceWithSmallOther) {
+  multiset<int> a;
+  for (int i = 0; i < 1000; ++i) a.insert(i % 100);
+  multiset<int> b{5, 5, 7};
+  a.difference(b);
+  EXPECT_EQ(a.size(), 997);
+  EXPECT_EQ(a.count(5), 8);
+  EXPECT_EQ(a.count(7), 9);
+}
+
+// Тест split_at/join для order_statistic_multiset
+TEST(MultisetTest, SplitAtAndJoin) {
+  order_statistic_multiset<int> ms{1, 2, 2, 3, 3, 3, 4};
+  auto tail = ms.split_at(3);
+  EXPECT_EQ(ms.size(), 3);
+  EXPECT_EQ(tail.size(), 4);
+  EXPECT_EQ(tail.count(3), 3);
+  EXPECT_EQ(tail.rank(4), 3);
+
+  ms.join(tail);
+  EXPECT_EQ(ms.size(), 7);
+  EXPECT_EQ(*ms.nth_element(6), 4);
+  EXPECT_EQ(ms.count_range(2, 3), 5);
+}
+
+// Тест мультимножества на компактных узлах
+TEST(MultisetTest, CompactMultiset) {
+  compact_multiset<uint64_t> ms{3, 1, 3, 2, 3};
+  EXPECT_EQ(ms.size(), 5);
+  EXPECT_EQ(ms.count(3), 3);
+  auto [first, last] = ms.equal_range(3);
+  EXPECT_EQ(std::distance(first, last), 3);
+  ms.erase(ms.find(3));
+  EXPECT_EQ(ms.count(3), 2);
+  EXPECT_EQ(*ms.begin(), 1);
+}
+
+// Тест мультимножества на B+-дереве
+TEST(MultisetTest, BTreeBackend) {
+  btree_multiset<std::string> ms{"b", "a", "b", "c"};
+  std::multiset<std::string> std_ms{"b", "a", "b", "c"};
+  for (int i = 0; i < 3000; ++i) {
+    std::string key(1, static_cast<char>('a' + i % 26));
+    ms.insert(key);
+    std_ms.insert(key);
+  }
+  EXPECT_EQ(ms.count("b"), std_ms.count("b"));
+  EXPECT_TRUE(
+      std::equal(ms.begin(), ms.end(), std_ms.begin(), std_ms.end()));
+
+  btree_multiset<std::string> other{"a", "zz"};
+  ms.merge(other);
+  EXPECT_TRUE(other.empty());
+  EXPECT_EQ(ms.count("a"), std_ms.count("a") + 1);
+  EXPECT_TRUE(ms.contains("zz"));
+}
+
+// Тест обратного обхода и декремента итераторов
+TEST(MultisetTest, ReverseIteration) {
+  multiset<int> ms{3, 1, 3, 2, 5};
+  std::multiset<int> std_ms{3, 1, 3, 2, 5};
+  EXPECT_TRUE(
+      std::equal(ms.rbegin(), ms.rend(), std_ms.rbegin(), std_ms.rend()));
+  auto it = ms.end();
+  EXPECT_EQ(*--it, 5);
+  EXPECT_EQ(*--it, 3);
+  ms.insert(7);
+  EXPECT_EQ(*ms.rbegin(), 7);
+  ms.erase(ms.find(7));
+  ms.erase(ms.find(5));
+  EXPECT_EQ(*ms.rbegin(), 3);
+
+  // Три наибольших элемента без обхода всего мультимножества
+  std::vector<int> top(ms.rbegin(), std::next(ms.rbegin(), 3));
+  EXPECT_EQ(top, (std::vector<int>{3, 3, 2}));
+}
+
+// Мультимножество как очередь с приоритетом
+TEST(MultisetTest, FrontBackAndPop) {
+  multiset<int> ms{5, 1, 4, 1, 9};
+  EXPECT_EQ(ms.front(), 1);
+  EXPECT_EQ(ms.back(), 9);
+  ms.pop_min();
+  EXPECT_EQ(ms.front(), 1);
+  ms.pop_min();
+  ms.pop_max();
+  EXPECT_EQ(ms.front(), 4);
+  EXPECT_EQ(ms.back(), 5);
+  EXPECT_EQ(*ms.begin(), 4);
+  ms.pop_max();
+  ms.pop_max();
+  EXPECT_TRUE(ms.empty());
+  ms.pop_min();
+  ms.pop_max();
+  EXPECT_TRUE(ms.empty());
+
+  // Выдача задач в порядке приоритета при одновременном поступлении новых
+  btree_multiset<int> queue;
+  std::priority_queue<int, std::vector<int>, std::greater<int>> reference;
+  std::mt19937 gen(31);
+  for (int i = 0; i < 20000; ++i) {
+    if (reference.empty() || gen() % 3) {
+      int key = static_cast<int>(gen() % 1000);
+      queue.insert(key);
+      reference.push(key);
+    } else {
+      ASSERT_EQ(queue.front(), reference.top());
+      queue.pop_min();
+      reference.pop();
+    }
+  }
+  EXPECT_EQ(queue.size(), reference.size());
+}
+
+// Удаление по итератору убирает именно этот узел среди равных
+TEST(MultisetTest, EraseExactNodeByIterator) {
+  multiset<int> ms{1, 2, 2, 2, 3};
+  auto first = ms.find(2);
+  auto second = std::next(first);
+  auto third = std::next(second);
+  const int* kept_first = &*first;
+  const int* kept_third = &*third;
+  auto next = ms.erase(second);
+  EXPECT_EQ(next, third);
+  EXPECT_EQ(ms.count(2), 2);
+  EXPECT_EQ(&*ms.find(2), kept_first);
+  EXPECT_EQ(&*std::next(ms.find(2)), kept_third);
+  EXPECT_EQ(ms.erase(ms.end()), ms.end());
+
+  next = ms.erase(ms.begin(), ms.find(3));
+  EXPECT_EQ(*next, 3);
+  EXPECT_EQ(ms.size(), 1);
+  EXPECT_EQ(ms.erase(ms.begin(), ms.end()), ms.end());
+  EXPECT_TRUE(ms.empty());
+}
+
+TEST(MultisetTest, EraseRangeMatchesStd) {
+  order_statistic_multiset<int> ms;
+  btree_multiset<int> bms;
+  std::multiset<int> std_ms;
+  std::mt19937 gen(37);
+  for (int i = 0; i < 20000; ++i) {
+    int key = static_cast<int>(gen() % 2000);
+    ms.insert(key);
+    bms.insert(key);
+    std_ms.insert(key);
+  }
+  for (int round = 0; round < 50; ++round) {
+    int lo = static_cast<int>(gen() % 2000);
+    int hi = lo + static_cast<int>(gen() % 100);
+    auto it = ms.erase(ms.lower_bound(lo), ms.upper_bound(hi));
+    auto bit = bms.erase(bms.lower_bound(lo), bms.upper_bound(hi));
+    auto std_it =
+        std_ms.erase(std_ms.lower_bound(lo), std_ms.upper_bound(hi));
+    ASSERT_EQ(it == ms.end(), std_it == std_ms.end());
+    ASSERT_EQ(bit == bms.end(), std_it == std_ms.end());
+    if (std_it != std_ms.end()) {
+      ASSERT_EQ(*it, *std_it);
+      ASSERT_EQ(*bit, *std_it);
+    }
+  }
+  EXPECT_TRUE(std::equal(ms.begin(), ms.end(), std_ms.begin(), std_ms.end()));
+  EXPECT_TRUE(
+      std::equal(bms.begin(), bms.end(), std_ms.begin(), std_ms.end()));
+  EXPECT_EQ(ms.rank(1000), std::distance(std_ms.begin(),
+                                         std_ms.lower_bound(1000)));
+}
+
+TEST(MultisetTest, InsertWithHint) {
+  multiset<int> ms;
+  std::multiset<int> std_ms;
+  // Поток по возрастанию с подсказкой end(), затем по убыванию с
+  // подсказкой на предыдущий вставленный элемент
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_EQ(*ms.insert(ms.end(), i / 2), i / 2);
+    std_ms.insert(i / 2);
+  }
+  auto hint = ms.begin();
+  for (int i = 0; i > -1000; --i) {
+    hint = ms.insert(hint, i / 3);
+    std_ms.insert(i / 3);
+  }
+  // Неверная подсказка не ломает порядок
+  ms.insert(ms.begin(), 10000);
+  std_ms.insert(10000);
+  ms.insert(ms.end(), -10000);
+  std_ms.insert(-10000);
+  EXPECT_TRUE(std::equal(ms.begin(), ms.end(), std_ms.begin(), std_ms.end()));
+  EXPECT_EQ(ms.back(), 10000);
+  EXPECT_EQ(ms.front(), -10000);
+}
+
+TEST(MultisetTest, EmplaceKeepsEqualKeys) {
+  multiset<std::pair<int, std::string>> ms;
+  ms.emplace(1, "a");
+  ms.emplace(1, "a");
+  auto it = ms.emplace_hint(ms.end(), 2, "b");
+  EXPECT_EQ((*it).second, "b");
+  std::pair<int, std::string> value(0, std::string(40, 'z'));
+  ms.insert(std::move(value));
+  EXPECT_TRUE(value.second.empty());
+  EXPECT_EQ(ms.size(), 4);
+  EXPECT_EQ(ms.count({1, "a"}), 2);
+  auto results = ms.insert_many(std::make_pair(3, "c"), std::make_pair(3, "c"));
+  EXPECT_EQ(results.size(), 2);
+  EXPECT_EQ(ms.back().first, 3);
+}
+
+TEST(MultisetTest, MergeRelinksWithoutAllocation) {
+  auto pool = std::make_shared<multiset<int>::node_pool>();
+  multiset<int> ms1(pool);
+  multiset<int> ms2(pool);
+  ms1.insert_many(1, 2, 2);
+  ms2.insert_many(2, 3);
+  const int* address = &*ms2.find(2);
+  ms1.merge(ms2);
+  EXPECT_TRUE(ms2.empty());
+  EXPECT_EQ(ms1.size(), 5);
+  EXPECT_EQ(pool->in_use(), 5);
+  // Равный ключ из other встаёт после имеющихся, в том же узле
+  auto [lower, upper] = ms1.equal_range(2);
+  EXPECT_EQ(std::distance(lower, upper), 3);
+  EXPECT_EQ(&*std::prev(upper), address);
+
+  // Без общего пула ключи перемещаются в новые узлы, а узлы other
+  // возвращаются в его пул
+  multiset<int> big;
+  multiset<int> other;
+  for (int i = 0; i < 5000; ++i) {
+    big.insert(i);
+    other.insert(i);
+  }
+  auto node = other.extract(other.begin());
+  EXPECT_EQ(node.value(), 0);
+  big.insert(std::move(node));
+  big.merge(other);
+  EXPECT_EQ(big.size(), 10000);
+  EXPECT_EQ(big.count(0), 2);
+  EXPECT_TRUE(other.empty());
+  multiset<int> copy(big);
+  EXPECT_EQ(copy.size(), 10000);
+
+  btree_multiset<int> b1{1, 1};
+  btree_multiset<int> b2{1, 2};
+  b1.merge(b2);
+  EXPECT_EQ(b1.count(1), 3);
+  EXPECT_TRUE(b2.empty());
+}
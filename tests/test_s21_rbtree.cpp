@@ -927,3 +927,732 @@ TEST(RBTreeTest, HandleBlackUncleLeftStringWithDuplicates) {
   EXPECT_TRUE(tree.contains("banana"));
   EXPECT_EQ(tree.size(), 4);
 }
+
+// Тесты пула узлов
+TEST(RBTreeTest, PoolReusesErasedNodes) {
+  RBTree<int> tree;
+  for (int i = 0; i < 100; ++i) {
+    tree.insert(i);
+  }
+  size_t capacity = tree.pool()->capacity();
+  EXPECT_EQ(tree.pool()->in_use(), 100);
+
+  for (int i = 0; i < 50; ++i) {
+    tree.erase(i);
+  }
+  EXPECT_EQ(tree.pool()->in_use(), 50);
+  for (int i = 100; i < 150; ++i) {
+    tree.insert(i);
+  }
+  EXPECT_EQ(tree.pool()->in_use(), 100);
+  EXPECT_EQ(tree.pool()->capacity(), capacity);
+}
+
+TEST(RBTreeTest, SharedPoolBetweenTrees) {
+  auto pool = std::make_shared<RBTree<std::string>::node_pool>();
+  {
+    RBTree<std::string> first(pool);
+    RBTree<std::string> second(pool);
+    first.insert("apple");
+    first.insert("banana");
+    second.insert("cherry");
+    EXPECT_EQ(pool->in_use(), 3);
+
+    first.clear();
+    EXPECT_EQ(pool->in_use(), 1);
+    EXPECT_TRUE(second.contains("cherry"));
+  }
+  EXPECT_EQ(pool->in_use(), 0);
+}
+
+TEST(RBTreeTest, ClearReleasesOwnPool) {
+  RBTree<int, true> tree;
+  for (int i = 0; i < 1000; ++i) {
+    tree.insert(i % 10);
+  }
+  tree.clear();
+  EXPECT_EQ(tree.pool()->in_use(), 0);
+  EXPECT_TRUE(tree.empty());
+  tree.insert(5);
+  EXPECT_EQ(tree.count(5), 1);
+}
+
+TEST(RBTreeTest, ClearReleasesOwnPoolWithNonTrivialKeys) {
+  RBTree<std::string> tree;
+  for (int i = 0; i < 1000; ++i) {
+    tree.insert(std::string(40, 'k') + std::to_string(i));
+  }
+  EXPECT_GT(tree.pool()->capacity(), 0);
+  tree.clear();
+  EXPECT_EQ(tree.pool()->in_use(), 0);
+  EXPECT_EQ(tree.pool()->capacity(), 0);
+  tree.insert("again");
+  EXPECT_TRUE(tree.contains("again"));
+}
+
+TEST(RBTreeTest, MoveKeepsPool) {
+  RBTree<int> tree;
+  tree.insert(1);
+  tree.insert(2);
+  auto pool = tree.pool();
+  RBTree<int> moved(std::move(tree));
+  EXPECT_EQ(moved.pool(), pool);
+  EXPECT_EQ(pool->in_use(), 2);
+  EXPECT_NE(tree.pool(), pool);
+}
+
+// Возвращает черную высоту поддерева или -1, если свойства RB нарушены
+template <typename Node>
+static int checkRBSubtree(const Node* node) {
+  if (!node) return 1;
+  if (node->left && node->left->getParent() != node) return -1;
+  if (node->right && node->right->getParent() != node) return -1;
+  if (node->getColor() == Color::RED &&
+      ((node->left && node->left->getColor() == Color::RED) ||
+       (node->right && node->right->getColor() == Color::RED))) {
+    return -1;
+  }
+  int left = checkRBSubtree(node->left);
+  int right = checkRBSubtree(node->right);
+  if (left < 0 || left != right) return -1;
+  return left + (node->getColor() == Color::BLACK ? 1 : 0);
+}
+
+TEST(RBTreeTest, RandomInsertEraseKeepsInvariants) {
+  RBTree<int> tree;
+  std::set<int> reference;
+  std::mt19937 gen(7);
+  for (int i = 0; i < 20000; ++i) {
+    int key = static_cast<int>(gen() % 2000);
+    if (gen() % 3 == 0) {
+      tree.erase(key);
+      reference.erase(key);
+    } else {
+      tree.insert(key);
+      reference.insert(key);
+    }
+  }
+  EXPECT_EQ(tree.size(), reference.size());
+  EXPECT_GT(checkRBSubtree(tree.getRoot()), 0);
+  for (int key : reference) {
+    EXPECT_TRUE(tree.contains(key));
+  }
+}
+
+// Тест результата вставки: узел и флаг
+TEST(RBTreeTest, InsertReturnsNodeAndFlag) {
+  RBTree<int> tree;
+  for (int key : {50, 30, 70, 20, 40, 60, 80}) {
+    auto [node, inserted] = tree.insert(key);
+    EXPECT_TRUE(inserted);
+    EXPECT_EQ(node->data, key);
+    EXPECT_EQ(node, tree.find(key));
+  }
+  auto [node, inserted] = tree.insert(40);
+  EXPECT_FALSE(inserted);
+  EXPECT_EQ(node, tree.find(40));
+  EXPECT_EQ(tree.size(), 7);
+}
+
+TEST(RBTreeMultisetTest, InsertReturnsNewNode) {
+  RBTree<int, true> tree;
+  tree.insert(10);
+  auto first = tree.insert(20);
+  auto second = tree.insert(20);
+  tree.insert(30);
+  EXPECT_TRUE(first.second);
+  EXPECT_TRUE(second.second);
+  EXPECT_NE(first.first, second.first);
+  // Равные ключи вставляются после уже имеющихся
+  EXPECT_EQ(tree.successor(first.first), second.first);
+  EXPECT_EQ(tree.successor(second.first)->data, 30);
+}
+
+// Проверяет, что размеры поддеревьев совпадают с реальными
+template <typename Node>
+static size_t checkSubtreeSizes(const Node* node, bool& valid) {
+  if (!node) return 0;
+  size_t size = checkSubtreeSizes(node->left, valid) +
+                checkSubtreeSizes(node->right, valid) + 1;
+  if (node->subtree_size != size) valid = false;
+  return size;
+}
+
+// Тест режима порядковой статистики на случайных вставках и удалениях
+TEST(RBTreeMultisetTest, OrderStatisticMatchesStd) {
+  RBTree<int, true, std::less<int>, true> tree;
+  std::multiset<int> reference;
+  std::mt19937 gen(5);
+  for (int i = 0; i < 5000; ++i) {
+    int key = static_cast<int>(gen() % 500);
+    if (gen() % 4 == 0) {
+      tree.erase(key);
+      auto it = reference.find(key);
+      if (it != reference.end()) reference.erase(it);
+    } else {
+      tree.insert(key);
+      reference.insert(key);
+    }
+  }
+  bool valid = true;
+  EXPECT_EQ(checkSubtreeSizes(tree.getRoot(), valid), reference.size());
+  EXPECT_TRUE(valid);
+  EXPECT_GT(checkRBSubtree(tree.getRoot()), 0);
+
+  size_t k = 0;
+  for (int key : reference) {
+    EXPECT_EQ(tree.select(k++)->data, key);
+  }
+  EXPECT_EQ(tree.select(reference.size()), nullptr);
+  for (int key = -1; key <= 501; key += 7) {
+    size_t less = std::distance(reference.begin(), reference.lower_bound(key));
+    EXPECT_EQ(tree.rank(key), less);
+    EXPECT_EQ(tree.count(key), reference.count(key));
+    size_t in_range = std::distance(reference.lower_bound(key),
+                                    reference.upper_bound(key + 30));
+    EXPECT_EQ(tree.count_range(key, key + 30), in_range);
+  }
+  EXPECT_EQ(tree.count_range(10, 5), 0);
+}
+
+// Тест построения из отсортированной последовательности
+TEST(RBTreeTest, BuildFromSortedIsValid) {
+  for (int n = 0; n <= 130; ++n) {
+    std::vector<int> keys(n);
+    for (int i = 0; i < n; ++i) keys[i] = i * 2;
+    RBTree<int, false, std::less<int>, true> tree;
+    tree.insert(-1);
+    tree.buildFromSorted(keys.begin(), keys.size());
+    ASSERT_EQ(tree.size(), static_cast<size_t>(n));
+    ASSERT_GT(checkRBSubtree(tree.getRoot()), 0) << n;
+    bool valid = true;
+    EXPECT_EQ(checkSubtreeSizes(tree.getRoot(), valid), keys.size());
+    EXPECT_TRUE(valid);
+    EXPECT_FALSE(tree.contains(-1));
+    for (int i = 0; i < n; ++i) {
+      EXPECT_EQ(tree.select(i)->data, keys[i]);
+    }
+  }
+}
+
+TEST(RBTreeTest, BuildFromSortedThenModify) {
+  std::vector<int> keys(1000);
+  for (int i = 0; i < 1000; ++i) keys[i] = i;
+  RBTree<int> tree;
+  tree.buildFromSorted(keys.begin(), keys.size());
+  for (int i = 0; i < 1000; i += 3) tree.erase(i);
+  for (int i = 1000; i < 1200; ++i) tree.insert(i);
+  EXPECT_EQ(tree.size(), 866);
+  EXPECT_GT(checkRBSubtree(tree.getRoot()), 0);
+}
+
+TEST(RBTreeMultisetTest, InsertRangeKeepsDuplicates) {
+  std::vector<int> sorted{1, 2, 2, 2, 3, 5, 5};
+  RBTree<int, true> tree;
+  tree.insertRange(sorted.begin(), sorted.end());
+  EXPECT_EQ(tree.size(), 7);
+  EXPECT_EQ(tree.count(2), 3);
+  EXPECT_EQ(tree.count(5), 2);
+  EXPECT_GT(checkRBSubtree(tree.getRoot()), 0);
+
+  RBTree<int> unique;
+  unique.insertRange(sorted.begin(), sorted.end());
+  EXPECT_EQ(unique.size(), 4);
+  EXPECT_GT(checkRBSubtree(unique.getRoot()), 0);
+}
+
+// Сравнивает форму, раскраску и ключи двух деревьев
+template <typename Node>
+static bool sameStructure(const Node* lhs, const Node* rhs) {
+  if (!lhs || !rhs) return lhs == rhs;
+  return lhs != rhs && lhs->data == rhs->data &&
+         lhs->getColor() == rhs->getColor() &&
+         sameStructure(lhs->left, rhs->left) &&
+         sameStructure(lhs->right, rhs->right);
+}
+
+// Тест структурного копирования
+TEST(RBTreeTest, CopyPreservesStructure) {
+  RBTree<int, true, std::less<int>, true> tree;
+  std::mt19937 gen(3);
+  for (int i = 0; i < 5000; ++i) {
+    tree.insert(static_cast<int>(gen() % 1000));
+  }
+  RBTree<int, true, std::less<int>, true> copy(tree);
+  EXPECT_EQ(copy.size(), tree.size());
+  EXPECT_TRUE(sameStructure(tree.getRoot(), copy.getRoot()));
+  EXPECT_GT(checkRBSubtree(copy.getRoot()), 0);
+  bool valid = true;
+  EXPECT_EQ(checkSubtreeSizes(copy.getRoot(), valid), copy.size());
+  EXPECT_TRUE(valid);
+
+  RBTree<int, true, std::less<int>, true> assigned;
+  assigned.insert(42);
+  assigned = copy;
+  EXPECT_TRUE(sameStructure(tree.getRoot(), assigned.getRoot()));
+  EXPECT_NE(assigned.pool(), tree.pool());
+
+  RBTree<int, true, std::less<int>, true> empty;
+  assigned = empty;
+  EXPECT_TRUE(assigned.empty());
+}
+
+// Части разреза не разделяют пул: у каждой свои узлы и свои слэбы
+TEST(RBTreeTest, SplitGivesPartsSeparatePools) {
+  RBTree<std::string, false, std::less<std::string>, true> tree;
+  for (int i = 0; i < 1000; ++i) {
+    tree.insert(std::string(30, 'k') + std::to_string(1000 + i));
+  }
+  auto right = tree.split(std::string(30, 'k') + "1700");
+  EXPECT_NE(tree.pool(), right.pool());
+  EXPECT_EQ(tree.pool()->in_use(), 700);
+  EXPECT_EQ(right.pool()->in_use(), 300);
+  bool valid = true;
+  EXPECT_EQ(checkSubtreeSizes(right.getRoot(), valid), 300);
+  EXPECT_TRUE(valid);
+  EXPECT_GT(checkRBSubtree(right.getRoot()), 0);
+  EXPECT_EQ(right.first()->data, std::string(30, 'k') + "1700");
+  EXPECT_EQ(right.last()->data, std::string(30, 'k') + "1999");
+
+  // Меньшей может оказаться и левая часть
+  auto tail = tree.split(std::string(30, 'k') + "1100");
+  EXPECT_NE(tree.pool(), tail.pool());
+  EXPECT_EQ(tree.pool()->in_use(), 100);
+  EXPECT_EQ(tail.pool()->in_use(), 600);
+  EXPECT_EQ(checkSubtreeSizes(tree.getRoot(), valid), 100);
+  EXPECT_TRUE(valid);
+  EXPECT_EQ(tree.last()->data, std::string(30, 'k') + "1099");
+  tail.clear();
+  EXPECT_EQ(tree.size(), 100);
+  EXPECT_EQ(tree.pool()->in_use(), 100);
+}
+
+// Тест split/join на случайных деревьях и ключах разреза
+TEST(RBTreeTest, SplitAndJoinKeepInvariants) {
+  std::mt19937 gen(17);
+  for (int round = 0; round < 40; ++round) {
+    RBTree<int> tree;
+    std::set<int> reference;
+    int n = static_cast<int>(gen() % 3000);
+    for (int i = 0; i < n; ++i) {
+      int key = static_cast<int>(gen() % 5000);
+      tree.insert(key);
+      reference.insert(key);
+    }
+    int cut = static_cast<int>(gen() % 5200) - 100;
+    RBTree<int> right = tree.split(cut);
+    size_t expected_left =
+        std::distance(reference.begin(), reference.lower_bound(cut));
+    ASSERT_EQ(tree.size(), expected_left);
+    ASSERT_EQ(right.size(), reference.size() - expected_left);
+    ASSERT_GT(checkRBSubtree(tree.getRoot()), 0);
+    ASSERT_GT(checkRBSubtree(right.getRoot()), 0);
+    if (!tree.empty()) {
+      EXPECT_EQ(tree.getRoot()->parent, nullptr);
+    }
+    for (int key : reference) {
+      EXPECT_EQ(tree.contains(key), key < cut);
+      EXPECT_EQ(right.contains(key), key >= cut);
+    }
+
+    tree.join(right);
+    EXPECT_TRUE(right.empty());
+    ASSERT_EQ(tree.size(), reference.size());
+    ASSERT_GT(checkRBSubtree(tree.getRoot()), 0);
+    auto it = reference.begin();
+    for (auto* node = tree.minimum(tree.getRoot()); node;
+         node = tree.successor(node)) {
+      EXPECT_EQ(node->data, *it++);
+    }
+  }
+}
+
+TEST(RBTreeMultisetTest, SplitOrderStatisticKeepsSizes) {
+  RBTree<int, true, std::less<int>, true> tree;
+  for (int i = 0; i < 2000; ++i) {
+    tree.insert(i % 500);
+  }
+  auto right = tree.split(250);
+  EXPECT_EQ(tree.size(), 1000);
+  EXPECT_EQ(right.size(), 1000);
+  EXPECT_EQ(right.count(250), 4);
+  EXPECT_EQ(tree.count(250), 0);
+  bool valid = true;
+  EXPECT_EQ(checkSubtreeSizes(tree.getRoot(), valid), 1000);
+  EXPECT_EQ(checkSubtreeSizes(right.getRoot(), valid), 1000);
+  EXPECT_TRUE(valid);
+  EXPECT_EQ(right.select(0)->data, 250);
+
+  // Равные ключи на границе допустимы в мультимножестве
+  RBTree<int, true, std::less<int>, true> tail;
+  tail.insert(499);
+  tail.insert(700);
+  right.join(tail);
+  EXPECT_EQ(right.size(), 1002);
+  EXPECT_EQ(right.count(499), 5);
+  EXPECT_EQ(checkSubtreeSizes(right.getRoot(), valid), 1002);
+  EXPECT_TRUE(valid);
+  EXPECT_GT(checkRBSubtree(right.getRoot()), 0);
+}
+
+TEST(RBTreeTest, JoinDifferentPools) {
+  RBTree<std::string> left;
+  RBTree<std::string> right;
+  for (char c = 'a'; c <= 'm'; ++c) left.insert(std::string(3, c));
+  for (char c = 'n'; c <= 'z'; ++c) right.insert(std::string(3, c));
+  left.join(right);
+  EXPECT_EQ(left.size(), 26);
+  EXPECT_EQ(left.pool()->in_use(), 26);
+  EXPECT_TRUE(right.empty());
+  left.erase("zzz");
+  EXPECT_EQ(left.pool()->in_use(), 25);
+  EXPECT_GT(checkRBSubtree(left.getRoot()), 0);
+
+  RBTree<std::string> overlap;
+  overlap.insert("ccc");
+  EXPECT_THROW(left.join(overlap), std::invalid_argument);
+  EXPECT_EQ(overlap.size(), 1);
+}
+
+TEST(RBTreeTest, ClearFreesEveryNodeOfSharedPool) {
+  // Общий пул не даёт clear просто вернуть слэбы: узлы освобождаются
+  // по одному обходом без рекурсии
+  auto pool = std::make_shared<RBTree<std::string, true>::node_pool>();
+  RBTree<std::string, true> tree(pool);
+  RBTree<std::string, true> other(pool);
+  other.insert("keep");
+  for (int i = 0; i < 100000; ++i) {
+    tree.insert(std::to_string(i % 5000));
+  }
+  EXPECT_EQ(pool->in_use(), 100001);
+  tree.clear();
+  EXPECT_TRUE(tree.empty());
+  EXPECT_EQ(pool->in_use(), 1);
+  EXPECT_TRUE(other.contains("keep"));
+  tree.insert("again");
+  EXPECT_EQ(tree.find("again")->data, "again");
+}
+
+TEST(RBTreeTest, FindStopsOnEqualKey) {
+  RBTree<long> tree;
+  for (long i = 0; i < 2000; i += 2) {
+    tree.insert(i);
+  }
+  for (long i = -1; i < 2000; ++i) {
+    const RBTree<long>::Node* node = tree.find(i);
+    if (i % 2 == 0) {
+      ASSERT_NE(node, nullptr);
+      EXPECT_EQ(node->data, i);
+    } else {
+      EXPECT_EQ(node, nullptr);
+    }
+  }
+}
+
+TEST(RBTreeTest, CompactNodesKeepColorInParentPointer) {
+  using Compact = RBTree<uint64_t, false, std::less<uint64_t>, false, true>;
+  EXPECT_LT(sizeof(Compact::Node), sizeof(RBTree<uint64_t>::Node));
+
+  Compact::Node node(7);
+  EXPECT_EQ(node.getColor(), Color::RED);
+  EXPECT_EQ(node.getParent(), nullptr);
+  node.setColor(Color::BLACK);
+  node.setParent(&node);
+  EXPECT_EQ(node.getParent(), &node);
+  EXPECT_EQ(node.getColor(), Color::BLACK);
+  node.setParent(nullptr);
+  EXPECT_EQ(node.getColor(), Color::BLACK);
+}
+
+TEST(RBTreeMultisetTest, CompactNodesMatchDefaultLayout) {
+  RBTree<int, true> plain;
+  RBTree<int, true, std::less<int>, true, true> compact;
+  std::mt19937 gen(11);
+  for (int i = 0; i < 5000; ++i) {
+    int key = static_cast<int>(gen() % 700);
+    if (gen() % 3 == 0) {
+      plain.erase(key);
+      compact.erase(key);
+    } else {
+      plain.insert(key);
+      compact.insert(key);
+    }
+  }
+  ASSERT_EQ(compact.size(), plain.size());
+  EXPECT_GT(checkRBSubtree(compact.getRoot()), 0);
+  bool valid = true;
+  EXPECT_EQ(checkSubtreeSizes(compact.getRoot(), valid), compact.size());
+  EXPECT_TRUE(valid);
+  for (int key = 0; key < 700; ++key) {
+    EXPECT_EQ(compact.count(key), plain.count(key)) << key;
+  }
+
+  auto copy = compact;
+  EXPECT_TRUE(sameStructure(copy.getRoot(), compact.getRoot()));
+  auto right = copy.split(350);
+  EXPECT_GT(checkRBSubtree(copy.getRoot()), 0);
+  EXPECT_GT(checkRBSubtree(right.getRoot()), 0);
+  copy.join(right);
+  EXPECT_EQ(copy.size(), compact.size());
+}
+
+TEST(RBTreeMultisetTest, PredecessorAndLastFollowUpdates) {
+  RBTree<int, true> tree;
+  std::multiset<int> reference;
+  std::mt19937 gen(21);
+  for (int i = 0; i < 4000; ++i) {
+    int key = static_cast<int>(gen() % 300);
+    if (gen() % 3 == 0) {
+      tree.erase(key);
+      auto it = reference.find(key);
+      if (it != reference.end()) reference.erase(it);
+    } else {
+      tree.insert(key);
+      reference.insert(key);
+    }
+    if (reference.empty()) {
+      ASSERT_EQ(tree.last(), nullptr);
+    } else {
+      ASSERT_NE(tree.last(), nullptr);
+      ASSERT_EQ(tree.last()->data, *reference.rbegin());
+      ASSERT_EQ(tree.last()->right, nullptr);
+    }
+  }
+  std::vector<int> backwards;
+  for (auto node = tree.last(); node; node = tree.predecessor(node)) {
+    backwards.push_back(node->data);
+  }
+  EXPECT_EQ(backwards, std::vector<int>(reference.rbegin(), reference.rend()));
+}
+
+TEST(RBTreeTest, LastAfterBulkOperations) {
+  std::vector<int> sorted{1, 3, 5, 7, 9, 11};
+  RBTree<int> tree;
+  tree.insertRange(sorted.begin(), sorted.end());
+  EXPECT_EQ(tree.last()->data, 11);
+
+  RBTree<int> copy(tree);
+  EXPECT_EQ(copy.last()->data, 11);
+
+  auto right = copy.split(6);
+  EXPECT_EQ(copy.last()->data, 5);
+  EXPECT_EQ(right.last()->data, 11);
+  RBTree<int> single;
+  single.insert(20);
+  right.join(single);
+  EXPECT_EQ(right.last()->data, 20);
+  EXPECT_EQ(single.last(), nullptr);
+  copy.join(right);
+  EXPECT_EQ(copy.last()->data, 20);
+
+  RBTree<int> other;
+  other.insert(4);
+  other.insert(30);
+  tree.unionWith(other);
+  EXPECT_EQ(tree.last()->data, 30);
+  tree.clear();
+  EXPECT_EQ(tree.last(), nullptr);
+}
+
+TEST(RBTreeMultisetTest, FirstAndPopFollowUpdates) {
+  RBTree<int, true> tree;
+  std::multiset<int> reference;
+  std::mt19937 gen(23);
+  for (int i = 0; i < 6000; ++i) {
+    int key = static_cast<int>(gen() % 400);
+    switch (gen() % 5) {
+      case 0:
+        tree.popFirst();
+        if (!reference.empty()) reference.erase(reference.begin());
+        break;
+      case 1:
+        tree.popLast();
+        if (!reference.empty()) reference.erase(std::prev(reference.end()));
+        break;
+      case 2:
+        tree.erase(key);
+        if (reference.count(key)) reference.erase(reference.find(key));
+        break;
+      default:
+        tree.insert(key);
+        reference.insert(key);
+    }
+    ASSERT_EQ(tree.size(), reference.size());
+    if (reference.empty()) {
+      ASSERT_EQ(tree.first(), nullptr);
+      ASSERT_EQ(tree.last(), nullptr);
+    } else {
+      ASSERT_EQ(tree.first()->data, *reference.begin());
+      ASSERT_EQ(tree.first()->left, nullptr);
+      ASSERT_EQ(tree.last()->data, *reference.rbegin());
+    }
+  }
+  EXPECT_GT(checkRBSubtree(tree.getRoot()), 0);
+}
+
+TEST(RBTreeTest, FirstAfterBulkOperations) {
+  std::vector<int> sorted{1, 3, 5, 7, 9, 11};
+  RBTree<int> tree;
+  tree.insertRange(sorted.begin(), sorted.end());
+  EXPECT_EQ(tree.first()->data, 1);
+
+  RBTree<int> copy(tree);
+  EXPECT_EQ(copy.first()->data, 1);
+  auto right = copy.split(6);
+  EXPECT_EQ(copy.first()->data, 1);
+  EXPECT_EQ(right.first()->data, 7);
+  RBTree<int> empty;
+  empty.join(right);
+  EXPECT_EQ(empty.first()->data, 7);
+  EXPECT_EQ(right.first(), nullptr);
+  copy.join(empty);
+  EXPECT_EQ(copy.first()->data, 1);
+  EXPECT_EQ(empty.first(), nullptr);
+
+  RBTree<int> moved(std::move(copy));
+  EXPECT_EQ(moved.first()->data, 1);
+  EXPECT_EQ(copy.first(), nullptr);
+  moved.popFirst();
+  EXPECT_EQ(moved.first()->data, 3);
+  moved.clear();
+  EXPECT_EQ(moved.first(), nullptr);
+  moved.popFirst();
+  moved.popLast();
+  EXPECT_TRUE(moved.empty());
+}
+
+TEST(RBTreeMultisetTest, EraseAtKeepsOtherNodes) {
+  RBTree<int, true, std::less<int>, true> tree;
+  std::vector<RBTree<int, true, std::less<int>, true>::Node*> nodes;
+  for (int i = 0; i < 1000; ++i) {
+    nodes.push_back(tree.insert(i % 10).first);
+  }
+  std::mt19937 gen(43);
+  std::shuffle(nodes.begin(), nodes.end(), gen);
+  for (size_t i = 0; i < nodes.size(); i += 2) {
+    auto next = tree.successor(nodes[i]);
+    EXPECT_EQ(tree.eraseAt(nodes[i]), next);
+  }
+  EXPECT_EQ(tree.size(), 500);
+  EXPECT_GT(checkRBSubtree(tree.getRoot()), 0);
+  bool valid = true;
+  EXPECT_EQ(checkSubtreeSizes(tree.getRoot(), valid), 500);
+  EXPECT_TRUE(valid);
+  // Оставшиеся узлы не переехали
+  std::set<const void*> alive;
+  for (auto node = tree.first(); node; node = tree.successor(node)) {
+    alive.insert(node);
+  }
+  for (size_t i = 1; i < nodes.size(); i += 2) {
+    EXPECT_EQ(alive.count(nodes[i]), 1);
+  }
+  EXPECT_EQ(tree.eraseRange(tree.first(), nullptr), nullptr);
+  EXPECT_TRUE(tree.empty());
+}
+
+TEST(RBTreeMultisetTest, InsertHintWithAnyHint) {
+  RBTree<int, true, std::less<int>, true> tree;
+  std::multiset<int> reference;
+  std::mt19937 gen(47);
+  for (int i = 0; i < 5000; ++i) {
+    int key = static_cast<int>(gen() % 700);
+    // Подсказка бывает верной, соседней или случайной
+    decltype(tree.first()) hint = nullptr;
+    switch (gen() % 3) {
+      case 0:
+        hint = tree.lower_bound(key);
+        break;
+      case 1:
+        hint = tree.upper_bound(key);
+        break;
+      default:
+        hint = tree.select(gen() % (tree.size() + 1));
+    }
+    auto [node, inserted] = tree.insertHint(hint, key);
+    reference.insert(key);
+    ASSERT_TRUE(inserted);
+    ASSERT_EQ(node->data, key);
+  }
+  std::vector<int> values;
+  for (auto node = tree.first(); node; node = tree.successor(node)) {
+    values.push_back(node->data);
+  }
+  EXPECT_EQ(values, std::vector<int>(reference.begin(), reference.end()));
+  EXPECT_EQ(tree.last()->data, *reference.rbegin());
+  EXPECT_GT(checkRBSubtree(tree.getRoot()), 0);
+  bool valid = true;
+  EXPECT_EQ(checkSubtreeSizes(tree.getRoot(), valid), reference.size());
+  EXPECT_TRUE(valid);
+}
+
+TEST(RBTreeTest, InsertHintRejectsDuplicates) {
+  RBTree<int> tree;
+  for (int key : {10, 20, 30}) {
+    tree.insert(key);
+  }
+  auto twenty = tree.find(20);
+  EXPECT_EQ(tree.insertHint(twenty, 20), std::make_pair(twenty, false));
+  EXPECT_EQ(tree.insertHint(tree.find(30), 20), std::make_pair(twenty, false));
+  EXPECT_EQ(tree.insertHint(nullptr, 20), std::make_pair(twenty, false));
+  EXPECT_TRUE(tree.insertHint(twenty, 15).second);
+  EXPECT_TRUE(tree.insertHint(twenty, 25).second);
+  EXPECT_TRUE(tree.insertHint(nullptr, 5).second);
+  EXPECT_EQ(tree.size(), 6);
+  EXPECT_EQ(tree.first()->data, 5);
+  EXPECT_GT(checkRBSubtree(tree.getRoot()), 0);
+}
+
+TEST(RBTreeTest, MergeKeepsPoolsSeparate) {
+  RBTree<int> first;
+  RBTree<int> second;
+  for (int i = 0; i < 3000; ++i) {
+    first.insert(i * 2);
+    second.insert(i * 5);
+  }
+  first.merge(second);
+  // Пулы не объединяются: перенесённые ключи живут в узлах первого пула,
+  // а узлы второго вернулись в его пул
+  EXPECT_NE(first.pool(), second.pool());
+  EXPECT_EQ(first.pool()->in_use(), first.size());
+  EXPECT_EQ(second.pool()->in_use(), 600);
+  EXPECT_EQ(first.size() + second.size(), 6000);
+  EXPECT_EQ(second.size(), 600);
+  EXPECT_GT(checkRBSubtree(first.getRoot()), 0);
+
+  // Узел из чужого пула тоже не переходит: ключ перемещается в новый узел
+  auto handle = first.extract(2);
+  EXPECT_EQ(first.pool()->in_use(), first.size() + 1);
+  EXPECT_EQ(second.insert(std::move(handle)).first->data, 2);
+  EXPECT_TRUE(handle.empty());
+  EXPECT_EQ(first.pool()->in_use(), first.size());
+  EXPECT_EQ(second.pool()->in_use(), 601);
+
+  // После переноса деревья меняются независимо друг от друга
+  second.clear();
+  EXPECT_EQ(second.pool()->capacity(), 0);
+  EXPECT_EQ(first.pool()->in_use(), first.size());
+  first.insert(1);
+  EXPECT_NE(first.find(1), nullptr);
+}
+
+// Над явно разделённым пулом merge и вставка handle перевешивают узлы
+TEST(RBTreeTest, MergeRelinksWithinSharedPool) {
+  auto pool = std::make_shared<RBTree<int>::node_pool>();
+  RBTree<int> first(pool);
+  RBTree<int> second(pool);
+  for (int i = 0; i < 3000; ++i) {
+    first.insert(i * 2);
+    second.insert(i * 5);
+  }
+  size_t capacity = pool->capacity();
+  first.merge(second);
+  EXPECT_EQ(pool->capacity(), capacity);
+  EXPECT_EQ(pool->in_use(), 6000);
+  EXPECT_EQ(second.size(), 600);
+  EXPECT_GT(checkRBSubtree(first.getRoot()), 0);
+
+  auto handle = second.extract(5);
+  const int* address = &handle.value();
+  EXPECT_EQ(&first.insert(std::move(handle)).first->data, address);
+  EXPECT_EQ(pool->in_use(), 6000);
+}
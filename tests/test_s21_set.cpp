@@ -789,3 +789,711 @@ TEST(SetTest, BlackUncleHandling) {
   EXPECT_TRUE(s.contains({17, 17}));
   EXPECT_TRUE(s.contains({11, 11}));
 }
+
+// Тест общего пула узлов
+TEST(SetTest, SharedPool) {
+  auto pool = std::make_shared<set<int>::node_pool>();
+  set<int> s1(pool);
+  set<int> s2(pool);
+  s1.insert_many(1, 2, 3);
+  s2.insert_many(3, 4);
+  EXPECT_EQ(pool->in_use(), 5);
+
+  s1.erase(s1.find(2));
+  EXPECT_EQ(pool->in_use(), 4);
+  EXPECT_TRUE(s2.contains(4));
+  EXPECT_FALSE(s1.contains(2));
+}
+
+// Тест пользовательского компаратора
+TEST(SetTest, CustomCompare) {
+  set<int, std::greater<int>> s{3, 1, 4, 1, 5};
+  std::vector<int> order;
+  for (int value : s) {
+    order.push_back(value);
+  }
+  EXPECT_EQ(order, (std::vector<int>{5, 4, 3, 1}));
+  EXPECT_TRUE(s.contains(4));
+  EXPECT_EQ(s.count(1), 1);
+  EXPECT_FALSE(s.insert(3).second);
+
+  set<int, std::greater<int>> copy(s);
+  EXPECT_EQ(*copy.begin(), 5);
+}
+
+// Тест гетерогенного поиска по std::string_view без временных строк
+TEST(SetTest, TransparentLookup) {
+  set<std::string, std::less<>> s{"apple", "banana", "cherry"};
+  std::string_view key = "banana";
+  EXPECT_TRUE(s.contains(key));
+  EXPECT_EQ(*s.find(key), "banana");
+  EXPECT_EQ(s.count(std::string_view("date")), 0);
+  EXPECT_TRUE(s.find("date") == s.end());
+  EXPECT_TRUE(s.contains("cherry"));
+}
+
+// Компаратор, считающий количество вызовов
+struct CountingLess {
+  static inline size_t calls = 0;
+  bool operator()(int lhs, int rhs) const {
+    ++calls;
+    return lhs < rhs;
+  }
+};
+
+// Поиск делает одно сравнение на уровень дерева
+TEST(SetTest, FindOneComparisonPerLevel) {
+  set<int, CountingLess> s;
+  for (int i = 0; i < 1023; ++i) {
+    s.insert(i);
+  }
+  CountingLess::calls = 0;
+  EXPECT_TRUE(s.contains(511));
+  // Высота красно-черного дерева не превышает 2 * log2(n + 1)
+  EXPECT_LE(CountingLess::calls, 21);
+}
+
+// Тест lower_bound, upper_bound и equal_range
+TEST(SetTest, Bounds) {
+  set<int> s{10, 20, 30, 40};
+  EXPECT_EQ(*s.lower_bound(20), 20);
+  EXPECT_EQ(*s.lower_bound(25), 30);
+  EXPECT_EQ(*s.upper_bound(20), 30);
+  EXPECT_TRUE(s.upper_bound(40) == s.end());
+  EXPECT_EQ(*s.lower_bound(0), 10);
+
+  auto range = s.equal_range(30);
+  EXPECT_EQ(*range.first, 30);
+  EXPECT_EQ(*range.second, 40);
+
+  auto missing = s.equal_range(35);
+  EXPECT_TRUE(missing.first == missing.second);
+  EXPECT_EQ(*missing.first, 40);
+}
+
+// Тест порядковой статистики
+TEST(SetTest, OrderStatistic) {
+  order_statistic_set<int> s{50, 10, 40, 20, 30};
+  EXPECT_EQ(*s.nth_element(0), 10);
+  EXPECT_EQ(*s.nth_element(4), 50);
+  EXPECT_TRUE(s.nth_element(5) == s.end());
+  EXPECT_EQ(s.rank(30), 2);
+  EXPECT_EQ(s.rank(35), 3);
+  EXPECT_EQ(s.count_range(15, 40), 3);
+
+  s.erase(s.find(20));
+  EXPECT_EQ(*s.nth_element(1), 30);
+  EXPECT_EQ(s.rank(30), 1);
+}
+
+// Тест конструктора от диапазона
+TEST(SetTest, RangeConstructor) {
+  std::vector<int> sorted{1, 2, 3, 4, 5};
+  set<int> s(sorted.begin(), sorted.end());
+  EXPECT_EQ(s.size(), 5);
+  EXPECT_TRUE(s.contains(3));
+
+  std::vector<int> unsorted{5, 1, 4, 1, 2};
+  set<int> u(unsorted.begin(), unsorted.end());
+  std::vector<int> order(u.begin(), u.end());
+  EXPECT_EQ(order, (std::vector<int>{1, 2, 4, 5}));
+
+  set<int> from_set(s.begin(), s.end());
+  EXPECT_EQ(from_set.size(), 5);
+}
+
+// Копия большого множества совпадает с оригиналом
+TEST(SetTest, CopyLargeSet) {
+  set<int> original;
+  for (int i = 0; i < 10000; ++i) {
+    original.insert((i * 7919) % 10007);
+  }
+  set<int> copy(original);
+  set<int> assigned{1, 2, 3};
+  assigned = original;
+  EXPECT_EQ(copy.size(), original.size());
+  EXPECT_EQ(assigned.size(), original.size());
+  auto it = original.begin();
+  for (int value : copy) {
+    EXPECT_EQ(value, *it);
+    ++it;
+  }
+  copy.insert(20000);
+  EXPECT_FALSE(original.contains(20000));
+}
+
+// Тесты теоретико-множественных операций против std::set_*
+static std::vector<int> toVector(const set<int>& s) {
+  return std::vector<int>(s.begin(), s.end());
+}
+
+TEST(SetTest, SetAlgebraMatchesStd) {
+  std::mt19937 gen(9);
+  // Сравнимые размеры (слияние) и маленький второй операнд (поэлементно)
+  for (size_t other_size : {size_t{3}, size_t{2000}}) {
+    set<int> a;
+    set<int> b;
+    for (int i = 0; i < 2000; ++i) a.insert(static_cast<int>(gen() % 4000));
+    while (b.size() < other_size) b.insert(static_cast<int>(gen() % 4000));
+    std::vector<int> va = toVector(a);
+    std::vector<int> vb = toVector(b);
+    std::vector<int> expected;
+
+    set<int> u(a);
+    u.union_with(b);
+    std::set_union(va.begin(), va.end(), vb.begin(), vb.end(),
+                   std::back_inserter(expected));
+    EXPECT_EQ(toVector(u), expected);
+    EXPECT_EQ(u.size(), expected.size());
+
+    expected.clear();
+    set<int> i(a);
+    i.intersect_with(b);
+    std::set_intersection(va.begin(), va.end(), vb.begin(), vb.end(),
+                          std::back_inserter(expected));
+    EXPECT_EQ(toVector(i), expected);
+
+    expected.clear();
+    set<int> d(a);
+    d.difference(b);
+    std::set_difference(va.begin(), va.end(), vb.begin(), vb.end(),
+                        std::back_inserter(expected));
+    EXPECT_EQ(toVector(d), expected);
+
+    expected.clear();
+    set<int> sd(a);
+    sd.symmetric_difference(b);
+    std::set_symmetric_difference(va.begin(), va.end(), vb.begin(), vb.end(),
+                                  std::back_inserter(expected));
+    EXPECT_EQ(toVector(sd), expected);
+    sd.insert(-1);
+    EXPECT_TRUE(sd.contains(-1));
+  }
+}
+
+TEST(SetTest, SetAlgebraWithSelfAndEmpty) {
+  set<int> a{1, 2, 3};
+  set<int> empty;
+  a.union_with(a);
+  EXPECT_EQ(a.size(), 3);
+  a.intersect_with(a);
+  EXPECT_EQ(a.size(), 3);
+  a.union_with(empty);
+  EXPECT_EQ(a.size(), 3);
+  empty.union_with(a);
+  EXPECT_EQ(toVector(empty), (std::vector<int>{1, 2, 3}));
+  a.difference(a);
+  EXPECT_TRUE(a.empty());
+  EXPECT_TRUE(a.begin() == a.end());
+}
+
+// Тест разделения множества на шарды и обратного объединения
+TEST(SetTest, SplitAtAndJoin) {
+  set<int> s;
+  for (int i = 0; i < 100; ++i) s.insert(i);
+  set<int> upper = s.split_at(60);
+  set<int> middle = s.split_at(30);
+  EXPECT_EQ(s.size(), 30);
+  EXPECT_EQ(middle.size(), 30);
+  EXPECT_EQ(upper.size(), 40);
+  EXPECT_EQ(*middle.begin(), 30);
+  EXPECT_EQ(*upper.begin(), 60);
+  EXPECT_FALSE(s.contains(30));
+
+  s.join(middle);
+  s.join(upper);
+  EXPECT_EQ(s.size(), 100);
+  EXPECT_TRUE(middle.empty());
+  int expected = 0;
+  for (int value : s) {
+    EXPECT_EQ(value, expected++);
+  }
+
+  set<int> duplicate{99};
+  EXPECT_THROW(s.join(duplicate), std::invalid_argument);
+}
+
+// После split_at части не связаны общим пулом и меняются из разных
+// потоков независимо
+TEST(SetTest, SplitAtHalvesAreIndependent) {
+  set<int> lower;
+  for (int i = 0; i < 1000; ++i) lower.insert(i);
+  set<int> upper = lower.split_at(500);
+  std::thread left_worker([&lower] {
+    for (int i = 0; i < 20000; ++i) {
+      lower.insert(-1 - i);
+      lower.pop_min();
+    }
+  });
+  std::thread right_worker([&upper] {
+    for (int i = 0; i < 20000; ++i) {
+      upper.insert(1000 + i);
+      upper.pop_max();
+    }
+  });
+  left_worker.join();
+  right_worker.join();
+  EXPECT_EQ(lower.size(), 500);
+  EXPECT_EQ(upper.size(), 500);
+  EXPECT_EQ(lower.front(), 0);
+  EXPECT_EQ(lower.back(), 499);
+  EXPECT_EQ(upper.front(), 500);
+  EXPECT_EQ(upper.back(), 999);
+}
+
+// Без общего пула merge перемещает ключи в свои узлы, и после него
+// контейнеры можно менять из разных потоков
+TEST(SetTest, MergeKeepsContainersIndependent) {
+  set<int> s1;
+  set<int> s2;
+  for (int i = 0; i < 1000; ++i) {
+    s1.insert(i * 2);
+    s2.insert(i * 2 + 1);
+  }
+  s1.merge(s2);
+  EXPECT_EQ(s1.size(), 2000);
+  EXPECT_TRUE(s2.empty());
+  s2.insert(s1.extract(1).value());
+  std::thread first_worker([&s1] {
+    for (int i = 0; i < 20000; ++i) {
+      s1.insert(-1 - i);
+      s1.pop_min();
+    }
+  });
+  std::thread second_worker([&s2] {
+    for (int i = 0; i < 20000; ++i) {
+      s2.insert(5000 + i);
+      s2.pop_max();
+    }
+  });
+  first_worker.join();
+  second_worker.join();
+  EXPECT_EQ(s1.size(), 1999);
+  EXPECT_EQ(s2.size(), 1);
+  EXPECT_EQ(*s2.begin(), 1);
+}
+
+// Тест множества на компактных узлах
+TEST(SetTest, CompactSet) {
+  compact_set<std::string> s{"pear", "apple", "plum", "apple"};
+  EXPECT_EQ(s.size(), 3);
+  EXPECT_EQ(*s.begin(), "apple");
+  s.insert("cherry");
+  s.erase(s.find("pear"));
+  std::vector<std::string> order(s.begin(), s.end());
+  EXPECT_EQ(order, (std::vector<std::string>{"apple", "cherry", "plum"}));
+
+  compact_set<std::string> copy(s);
+  copy.insert("fig");
+  EXPECT_EQ(copy.size(), 4);
+  EXPECT_FALSE(s.contains("fig"));
+}
+
+// Тест множества на B+-дереве: тот же интерфейс, что и у обычного set
+TEST(SetTest, BTreeBackend) {
+  btree_set<int> s{5, 1, 4, 1, 3};
+  std::set<int> std_s{5, 1, 4, 1, 3};
+  for (int i = 0; i < 5000; ++i) {
+    int key = (i * 37) % 1000;
+    EXPECT_EQ(s.insert(key).second, std_s.insert(key).second);
+  }
+  s.erase(s.find(500));
+  std_s.erase(500);
+  EXPECT_EQ(s.size(), std_s.size());
+  EXPECT_TRUE(std::equal(s.begin(), s.end(), std_s.begin(), std_s.end()));
+  EXPECT_EQ(*s.lower_bound(500), 501);
+  EXPECT_EQ(*s.upper_bound(501), 502);
+
+  btree_set<int> other{-1, 0, 1, 2000};
+  s.merge(other);
+  EXPECT_EQ(std::vector<int>(other.begin(), other.end()),
+            (std::vector<int>{0, 1}));
+  EXPECT_TRUE(s.contains(-1));
+  EXPECT_TRUE(s.contains(2000));
+
+  btree_set<int> copy(s);
+  EXPECT_EQ(copy.size(), s.size());
+  EXPECT_TRUE(std::equal(copy.begin(), copy.end(), s.begin(), s.end()));
+}
+
+// Тест обратного обхода и декремента итераторов
+TEST(SetTest, ReverseIteration) {
+  set<int> s{4, 8, 15, 16, 23, 42};
+  std::vector<int> top(s.rbegin(), s.rend());
+  EXPECT_EQ(top, (std::vector<int>{42, 23, 16, 15, 8, 4}));
+
+  auto it = s.end();
+  --it;
+  EXPECT_EQ(*it, 42);
+  EXPECT_EQ(*it--, 42);
+  EXPECT_EQ(*it, 23);
+  EXPECT_EQ(*std::prev(s.find(15)), 8);
+
+  const set<int>& cs = s;
+  EXPECT_EQ(*cs.rbegin(), 42);
+  EXPECT_EQ(*std::next(cs.rbegin(), 2), 16);
+
+  btree_set<int> bs(s.begin(), s.end());
+  EXPECT_TRUE(std::equal(bs.rbegin(), bs.rend(), s.rbegin(), s.rend()));
+}
+
+TEST(SetTest, FrontBackAndPop) {
+  set<int> s{3, 8, 1, 6};
+  EXPECT_EQ(s.front(), 1);
+  EXPECT_EQ(s.back(), 8);
+  s.pop_min();
+  s.pop_max();
+  EXPECT_EQ(s.front(), 3);
+  EXPECT_EQ(s.back(), 6);
+  s.insert(0);
+  EXPECT_EQ(s.front(), 0);
+  EXPECT_EQ(*s.begin(), 0);
+  s.clear();
+  s.pop_min();
+  EXPECT_TRUE(s.empty());
+}
+
+TEST(SetTest, InsertWithHint) {
+  set<int> s{10, 20, 30};
+  auto twenty = s.find(20);
+  EXPECT_EQ(s.insert(twenty, 20), twenty);
+  EXPECT_EQ(s.insert(s.end(), 20), twenty);
+  EXPECT_EQ(*s.insert(twenty, 15), 15);
+  EXPECT_EQ(*s.insert(s.end(), 40), 40);
+  EXPECT_EQ(*s.insert(s.begin(), 35), 35);
+  EXPECT_EQ(s.size(), 6);
+  std::vector<int> values(s.begin(), s.end());
+  EXPECT_EQ(values, (std::vector<int>{10, 15, 20, 30, 35, 40}));
+
+  btree_set<int> bs;
+  for (int i = 0; i < 100; ++i) {
+    bs.insert(bs.end(), i);
+  }
+  EXPECT_EQ(bs.size(), 100);
+  EXPECT_EQ(bs.back(), 99);
+}
+
+// Ключ, считающий свои копирования и перемещения
+struct CountedKey {
+  static inline int copies = 0;
+  static inline int moves = 0;
+
+  int value;
+  std::string payload;
+
+  CountedKey(int v, std::string p) : value(v), payload(std::move(p)) {}
+  CountedKey(const CountedKey& other)
+      : value(other.value), payload(other.payload) {
+    copies++;
+  }
+  CountedKey(CountedKey&& other) noexcept
+      : value(other.value), payload(std::move(other.payload)) {
+    moves++;
+  }
+  CountedKey& operator=(const CountedKey&) = default;
+  CountedKey& operator=(CountedKey&&) = default;
+
+  bool operator<(const CountedKey& other) const { return value < other.value; }
+};
+
+TEST(SetTest, EmplaceAndMoveInsertDoNotCopy) {
+  CountedKey::copies = CountedKey::moves = 0;
+  set<CountedKey> s;
+  auto [it, inserted] = s.emplace(2, "two");
+  EXPECT_TRUE(inserted);
+  EXPECT_EQ((*it).payload, "two");
+  EXPECT_EQ(CountedKey::copies + CountedKey::moves, 0);
+
+  CountedKey one(1, std::string(100, 'x'));
+  EXPECT_TRUE(s.insert(std::move(one)).second);
+  EXPECT_EQ(CountedKey::copies, 0);
+  EXPECT_EQ(CountedKey::moves, 1);
+
+  // Равный ключ не вставляется и не забирается
+  CountedKey again(1, "kept");
+  EXPECT_FALSE(s.insert(std::move(again)).second);
+  EXPECT_EQ(again.payload, "kept");
+  EXPECT_FALSE(s.emplace(2, "dup").second);
+  EXPECT_EQ((*s.find(CountedKey(2, ""))).payload, "two");
+
+  auto hinted = s.emplace_hint(s.end(), 3, "three");
+  EXPECT_EQ((*hinted).value, 3);
+  s.insert(s.begin(), CountedKey(0, "zero"));
+  EXPECT_EQ(CountedKey::copies, 0);
+  EXPECT_EQ(s.size(), 4);
+  EXPECT_EQ(s.front().payload, "zero");
+}
+
+TEST(SetTest, InsertManyForwardsArguments) {
+  set<std::string> s;
+  std::string moved(50, 'm');
+  auto results = s.insert_many(std::move(moved), "literal", "literal");
+  EXPECT_TRUE(results[0].second);
+  EXPECT_TRUE(results[1].second);
+  EXPECT_FALSE(results[2].second);
+  EXPECT_TRUE(moved.empty());
+  EXPECT_EQ(s.size(), 2);
+
+  btree_set<std::string> bs;
+  bs.emplace(3, 'a');
+  bs.insert(std::string("b"));
+  EXPECT_EQ(bs.front(), "aaa");
+  EXPECT_EQ(*bs.emplace_hint(bs.end(), "c"), "c");
+  EXPECT_EQ(bs.size(), 3);
+}
+
+// Между множествами с общим пулом узел переходит без выделения памяти
+TEST(SetTest, ExtractAndInsertNode) {
+  auto pool = std::make_shared<set<std::string>::node_pool>();
+  set<std::string> source(pool);
+  set<std::string> target(pool);
+  source.insert_many("a", "b", "c");
+  target.insert("c");
+  const std::string* address = &*source.find("b");
+
+  auto node = source.extract("b");
+  ASSERT_FALSE(node.empty());
+  EXPECT_EQ(node.value(), "b");
+  EXPECT_EQ(source.size(), 2);
+  auto result = target.insert(std::move(node));
+  EXPECT_TRUE(result.inserted);
+  EXPECT_TRUE(result.node.empty());
+  EXPECT_EQ(&*result.position, address);
+
+  auto again = target.insert(source.extract(source.find("c")));
+  EXPECT_FALSE(again.inserted);
+  ASSERT_TRUE(static_cast<bool>(again.node));
+  EXPECT_EQ(again.node.value(), "c");
+  again.node.value() = "d";
+  auto renamed = target.insert(std::move(again.node));
+  EXPECT_TRUE(renamed.inserted);
+  EXPECT_EQ(*renamed.position, "d");
+
+  EXPECT_TRUE(source.extract("zz").empty());
+  EXPECT_TRUE(source.extract(source.end()).empty());
+  std::vector<std::string> values(target.begin(), target.end());
+  EXPECT_EQ(values, (std::vector<std::string>{"b", "c", "d"}));
+}
+
+TEST(SetTest, MergeRelinksNodes) {
+  auto pool = std::make_shared<set<int>::node_pool>();
+  set<int> s1(pool);
+  set<int> s2(pool);
+  for (int i = 0; i < 10000; ++i) {
+    s1.insert(i * 2);
+    s2.insert(i * 3);
+  }
+  std::set<const int*> nodes;
+  for (const int& value : s2) {
+    nodes.insert(&value);
+  }
+  s1.merge(s2);
+  EXPECT_EQ(s1.size(), 10000 + 10000 - 3334);
+  EXPECT_EQ(s2.size(), 3334);
+  // Перенесённые элементы остались в тех же узлах, новых не появилось
+  size_t moved = 0;
+  for (const int& value : s1) {
+    moved += nodes.count(&value);
+  }
+  EXPECT_EQ(moved, 10000 - 3334);
+  EXPECT_EQ(s1.size() + s2.size(), 20000);
+  for (int value : s2) {
+    EXPECT_EQ(value % 6, 0);
+  }
+
+  btree_set<int> b1{1, 2, 3};
+  btree_set<int> b2{3, 4};
+  b1.merge(b2);
+  EXPECT_EQ(b1.size(), 4);
+  EXPECT_EQ(b2.size(), 1);
+  auto node = b1.extract(4);
+  EXPECT_EQ(node.value(), 4);
+  EXPECT_TRUE(b2.insert(std::move(node)).inserted);
+  EXPECT_EQ(b2.back(), 4);
+}
+
+TEST(ConcurrentSetTest, SingleThreadOperations) {
+  concurrent_set<int> s;
+  EXPECT_TRUE(s.empty());
+  EXPECT_TRUE(s.insert(3));
+  EXPECT_TRUE(s.insert(1));
+  EXPECT_FALSE(s.insert(3));
+  EXPECT_EQ(s.size(), 2);
+  EXPECT_TRUE(s.contains(1));
+  EXPECT_EQ(s.find(3), std::optional<int>(3));
+  EXPECT_EQ(s.find(2), std::nullopt);
+  EXPECT_EQ(s.erase(1), 1);
+  EXPECT_EQ(s.erase(1), 0);
+  int first = s.read([](const auto& tree) { return tree.first()->data; });
+  EXPECT_EQ(first, 3);
+  s.clear();
+  EXPECT_TRUE(s.empty());
+}
+
+// Читатели видят каждую запись, завершившуюся до начала чтения, и не
+// видят недостроенного дерева
+TEST(ConcurrentSetTest, ReadersSeeCompletedWrites) {
+  concurrent_set<uint64_t> s;
+  std::atomic<uint64_t> published{0};
+  std::atomic<bool> done{false};
+  std::atomic<size_t> errors{0};
+  std::vector<std::thread> readers;
+  for (int t = 0; t < 4; ++t) {
+    readers.emplace_back([&, t] {
+      std::mt19937_64 gen(t);
+      while (!done.load()) {
+        uint64_t limit = published.load();
+        if (limit == 0) {
+          continue;
+        }
+        uint64_t key = gen() % limit;
+        // Чётные ключи только добавляются, нечётные удаляются следом
+        if (s.contains(key) != (key % 2 == 0)) {
+          errors++;
+        }
+      }
+    });
+  }
+  for (uint64_t key = 0; key < 4000; ++key) {
+    s.insert(key);
+    if (key % 2 == 1) {
+      s.erase(key);
+    }
+    published.store(key + 1);
+  }
+  done.store(true);
+  for (auto& reader : readers) {
+    reader.join();
+  }
+  EXPECT_EQ(errors.load(), 0);
+  EXPECT_EQ(s.size(), 2000);
+}
+
+// Проверяет свойства красно-чёрного дерева, возвращает чёрную высоту
+template <typename Ptr>
+static int blackHeight(const Ptr& node) {
+  if (!node) {
+    return 1;
+  }
+  if (node->color == Color::RED) {
+    EXPECT_FALSE(node->left && node->left->color == Color::RED);
+    EXPECT_FALSE(node->right && node->right->color == Color::RED);
+  }
+  int left = blackHeight(node->left);
+  EXPECT_EQ(left, blackHeight(node->right));
+  return left + (node->color == Color::BLACK ? 1 : 0);
+}
+
+TEST(PersistentSetTest, VersionsAreIndependent) {
+  persistent_set<int> v0{5, 1, 3};
+  auto v1 = v0.insert(4);
+  auto v2 = v1.erase(1);
+  EXPECT_EQ(v0, (persistent_set<int>{1, 3, 5}));
+  EXPECT_EQ(v1, (persistent_set<int>{1, 3, 4, 5}));
+  EXPECT_EQ(v2, (persistent_set<int>{3, 4, 5}));
+  EXPECT_EQ(*v2.find(4), 4);
+  EXPECT_EQ(v2.find(1), v2.end());
+  EXPECT_EQ(*v1.lower_bound(2), 3);
+  EXPECT_EQ(v2.lower_bound(6), v2.end());
+  // Без изменений возвращается та же версия
+  EXPECT_TRUE(v1.insert(3).shares_root(v1));
+  EXPECT_TRUE(v1.erase(7).shares_root(v1));
+  EXPECT_FALSE(v2.shares_root(v1));
+}
+
+// Сравнение с состоянием: порядок задаётся объектом, а не типом
+struct ModuloLess {
+  int modulo;
+  bool operator()(int a, int b) const { return a % modulo < b % modulo; }
+};
+
+TEST(PersistentSetTest, UsesStoredComparator) {
+  persistent_set<int, ModuloLess> s(ModuloLess{10});
+  s = s.insert(25).insert(13).insert(7).insert(31);
+  EXPECT_EQ(s.key_comp().modulo, 10);
+  std::vector<int> order{31, 13, 25, 7};
+  EXPECT_TRUE(std::equal(s.begin(), s.end(), order.begin(), order.end()));
+  // 45 эквивалентен 25 по модулю 10
+  auto it = s.find(45);
+  ASSERT_NE(it, s.end());
+  EXPECT_EQ(*it, 25);
+  // Итератор из find продолжает обход с найденного элемента
+  EXPECT_EQ(*++it, 7);
+  EXPECT_EQ(++it, s.end());
+  EXPECT_EQ(s.find(9), s.end());
+  EXPECT_TRUE(s.insert(41).shares_root(s));
+  persistent_set<int, ModuloLess> t(ModuloLess{10});
+  t = t.insert(17).insert(5).insert(3).insert(1);
+  EXPECT_EQ(s, t);
+  EXPECT_NE(s, t.erase(33));
+}
+
+TEST(PersistentSetTest, RandomHistoryMatchesStdSet) {
+  std::mt19937 gen(31);
+  std::vector<PersistentRBTree<int>> versions(1);
+  std::vector<std::set<int>> expected(1);
+  for (int i = 0; i < 4000; ++i) {
+    size_t base = gen() % versions.size();
+    int key = static_cast<int>(gen() % 700);
+    auto reference = expected[base];
+    if (gen() % 3 == 0) {
+      versions.push_back(versions[base].erase(key));
+      reference.erase(key);
+    } else {
+      versions.push_back(versions[base].insert(key));
+      reference.insert(key);
+    }
+    expected.push_back(reference);
+  }
+  // Старые версии не меняются от изменений, сделанных после них
+  for (size_t v = 0; v < versions.size(); v += 41) {
+    ASSERT_EQ(versions[v].size(), expected[v].size());
+    EXPECT_TRUE(std::equal(versions[v].begin(), versions[v].end(),
+                           expected[v].begin(), expected[v].end()));
+    EXPECT_FALSE(versions[v].root() &&
+                 versions[v].root()->color == Color::RED);
+    blackHeight(versions[v].root());
+  }
+}
+
+// Узлы версии, которых нет в другой версии
+template <typename Ptr>
+static size_t ownNodes(const Ptr& node, const std::set<const void*>& other) {
+  if (!node) {
+    return 0;
+  }
+  return (other.count(node.get()) ? 0 : 1) + ownNodes(node->left, other) +
+         ownNodes(node->right, other);
+}
+
+template <typename Ptr>
+static void collectNodes(const Ptr& node, std::set<const void*>& nodes) {
+  if (node) {
+    nodes.insert(node.get());
+    collectNodes(node->left, nodes);
+    collectNodes(node->right, nodes);
+  }
+}
+
+TEST(PersistentSetTest, UpdateCopiesOnlyThePath) {
+  PersistentRBTree<int> tree;
+  for (int i = 0; i < 20000; ++i) {
+    tree = tree.insert(i * 7 % 20011);
+  }
+  std::set<const void*> shared;
+  collectNodes(tree.root(), shared);
+  // Высота дерева не больше 2 log2(n + 1) ~ 29, новых узлов — порядка
+  // длины пути, а не размера дерева
+  auto inserted = tree.insert(30000);
+  EXPECT_LE(ownNodes(inserted.root(), shared), 64);
+  auto erased = tree.erase(7 * 1234 % 20011);
+  EXPECT_LE(ownNodes(erased.root(), shared), 96);
+  EXPECT_EQ(tree.size(), 20000);
+  EXPECT_EQ(inserted.size(), 20001);
+  EXPECT_EQ(erased.size(), 19999);
+  // Узел освобождается вместе с последней версией, которая на него
+  // ссылается
+  std::weak_ptr<const PersistentRBTree<int>::Node> root = erased.root();
+  erased = PersistentRBTree<int>();
+  EXPECT_TRUE(root.expired());
+}
@@ -3,11 +3,22 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <iostream>
+#include <iterator>
+#include <queue>
+#include <random>
 #include <set>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
 
+#include "../BTree/s21_btree.h"
 #include "../RBtree/s21_rbtree.h"
 #include "../multiset/s21_multiset.h"
+#include "../set/s21_concurrent_set.h"
+#include "../set/s21_persistent_set.h"
 #include "../set/s21_set.h"
 
 #endif
\ No newline at end of file